@@ -1,7 +1,7 @@
 #version 330 core
-uniform vec3 color;
+in vec3 ex_color;
 out vec4 FragColor;
 
 void main() {
-    FragColor = vec4(color, 1.0);
-}
\ No newline at end of file
+    FragColor = vec4(ex_color, 1.0);
+}
@@ -1,6 +1,12 @@
 #version 330 core
-layout(location = 0) in vec4 position;
+layout(location = 0) in vec3 in_pos;
+layout(location = 1) in vec3 in_color;
+
+uniform mat4 mvp;
+
+out vec3 ex_color;
 
 void main() {
-    gl_Position = position;
-}
\ No newline at end of file
+    gl_Position = mvp * vec4(in_pos, 1.0);
+    ex_color = in_color;
+}
@@ -0,0 +1,19 @@
+#version 330 core
+precision highp float;
+
+uniform sampler2DArray tex;
+in vec4 ex_uv;
+flat in int ex_layer;
+
+out vec4 FragColor;
+
+void main() {
+	// End of the render chain
+	if (ex_layer < 0) {
+		FragColor = vec4(1.0, 0.0, 1.0, 1.0);
+		return;
+	}
+	vec2 uv = (ex_uv.xy / ex_uv.w);
+	uv = uv*0.5 + 0.5;
+	FragColor = vec4(texture(tex, vec3(uv, float(ex_layer))).rgb, 1.0);
+}
@@ -0,0 +1,25 @@
+#version 330 core
+#extension GL_ARB_shader_viewport_layer_array : require
+
+#define MAX_VIEWS 16
+
+layout(location = 0) in vec3 in_pos;
+
+uniform mat4 viewProj[MAX_VIEWS];
+uniform mat4 model;
+uniform int srcLayer[MAX_VIEWS];
+
+out vec4 ex_uv;
+flat out int ex_layer;
+
+void main(void) {
+	gl_Layer = gl_InstanceID;
+	ex_layer = srcLayer[gl_InstanceID];
+	if (ex_layer == -1) {
+		// Hidden in this view, collapse outside the clip volume
+		gl_Position = vec4(2.0, 2.0, 2.0, 1.0);
+	} else {
+		gl_Position = viewProj[gl_InstanceID] * model * vec4(in_pos, 1.0);
+	}
+	ex_uv = gl_Position;
+}
@@ -0,0 +1,19 @@
+#version 330 core
+#extension GL_ARB_shader_viewport_layer_array : require
+
+#define MAX_VIEWS 16
+
+layout(location = 0) in vec3 in_pos;
+layout(location = 1) in vec2 in_uv;
+
+uniform mat4 invProj[MAX_VIEWS];
+uniform mat4 invView[MAX_VIEWS];
+
+out vec3 ex_normal;
+
+void main() {
+    gl_Layer = gl_InstanceID;
+    gl_Position = vec4(in_pos.xy, 0.0, 1.0);
+    vec3 eye_normal = normalize((invProj[gl_InstanceID] * gl_Position).xyz);
+    ex_normal = normalize((invView[gl_InstanceID] * vec4(eye_normal, 0.0)).xyz);
+}
@@ -1,8 +1,8 @@
 #version 330 core
 
 layout(location = 0) in vec3 in_pos;
-layout(location = 0) in vec3 in_uv;
-layout(location = 0) in vec3 in_normal;
+layout(location = 1) in vec3 in_uv;
+layout(location = 2) in vec3 in_normal;
 
 uniform mat4 mvp;
 uniform mat4 mv;
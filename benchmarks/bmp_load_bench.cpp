@@ -0,0 +1,115 @@
+// BMP load time across texture sizes and atlas tilings, against the previous per-pixel reader.
+// Usage: bmp_load_bench
+#include "resources/BmpImage.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <vector>
+
+namespace fs = std::filesystem;
+
+namespace {
+	constexpr int RUNS = 5;
+
+	void WriteBMP(const fs::path &path, int width, int height) {
+		const int stride = (width * 3 + 3) & ~3;
+		const uint32_t dataSize = static_cast<uint32_t>(stride) * height;
+		char header[54] = {'B', 'M'};
+		const uint32_t fileSize = 54 + dataSize;
+		const uint32_t offset = 54, infoSize = 40, zero = 0;
+		const uint16_t planes = 1, bpp = 24;
+		std::memcpy(header + 2, &fileSize, 4);
+		std::memcpy(header + 10, &offset, 4);
+		std::memcpy(header + 14, &infoSize, 4);
+		std::memcpy(header + 18, &width, 4);
+		std::memcpy(header + 22, &height, 4);
+		std::memcpy(header + 26, &planes, 2);
+		std::memcpy(header + 28, &bpp, 2);
+		std::memcpy(header + 30, &zero, 4);
+		std::memcpy(header + 34, &dataSize, 4);
+
+		std::vector<uint8_t> data(dataSize);
+		for (size_t i = 0; i < data.size(); ++i) {
+			data[i] = static_cast<uint8_t>((i * 2654435761u) >> 13);
+		}
+		std::ofstream out(path, std::ios::binary);
+		out.write(header, sizeof(header));
+		out.write(reinterpret_cast<const char *>(data.data()), static_cast<std::streamsize>(data.size()));
+	}
+
+	// The loader before the bulk read, kept here as the reference
+	std::vector<uint8_t> LoadPerPixel(const fs::path &path, int rows, int cols) {
+		std::ifstream fin(path, std::ios::in | std::ios::binary);
+		char input[54];
+		fin.read(input, 54);
+		int32_t width, height;
+		std::memcpy(&width, &input[18], 4);
+		std::memcpy(&height, &input[22], 4);
+		const int block_w = width / cols;
+		const int block_h = height / rows;
+		std::vector<uint8_t> img(static_cast<size_t>(width) * height * 3);
+		for (int y = height; y-- > 0;) {
+			const int row = y / block_h;
+			const int ty = y % block_h;
+			for (int x = 0; x < width; x++) {
+				const int col = x / block_w;
+				const int tx = x % block_w;
+				uint8_t *ptr = img.data() + ((row * cols + col) * (block_w * block_h) + ty * block_w + tx) * 3;
+				fin.read(reinterpret_cast<char *>(ptr), 3);
+			}
+			const int padding = (width * 3) % 4;
+			if (padding) {
+				char junk[3];
+				fin.read(junk, 4 - padding);
+			}
+		}
+		return img;
+	}
+
+	template<typename F>
+	double Best(F &&f) {
+		double best = 1e30;
+		for (int run = 0; run < RUNS; ++run) {
+			const auto t0 = std::chrono::steady_clock::now();
+			f();
+			const auto t1 = std::chrono::steady_clock::now();
+			best = std::min(best, std::chrono::duration<double, std::milli>(t1 - t0).count());
+		}
+		return best;
+	}
+}
+
+int main() {
+	const int sizes[] = {256, 1024, 2048, 4096};
+	const int tilings[][2] = {{1, 1}, {2, 2}, {4, 4}, {1, 8}, {16, 16}};
+
+	const fs::path dir = fs::temp_directory_path() / "ne_bmp_bench";
+	fs::create_directories(dir);
+
+	std::printf("%6s %7s %12s %10s %8s %s\n", "size", "tiling", "per-pixel ms", "bulk ms", "speedup", "match");
+	int mismatches = 0;
+	for (const int size: sizes) {
+		const fs::path path = dir / ("synthetic_" + std::to_string(size) + ".bmp");
+		WriteBMP(path, size, size);
+		for (const auto &tiling: tilings) {
+			const int rows = tiling[0];
+			const int cols = tiling[1];
+
+			std::vector<uint8_t> reference;
+			const double slow = Best([&] { reference = LoadPerPixel(path, rows, cols); });
+			BmpImage image;
+			const double fast = Best([&] { LoadBMP(path.string(), rows, cols, image); });
+
+			const bool match = image.size == reference.size() &&
+			                   std::memcmp(image.pixels.get(), reference.data(), reference.size()) == 0;
+			mismatches += !match;
+			std::printf("%6d %4dx%-2d %12.2f %10.2f %7.1fx %s\n", size, rows, cols, slow, fast, slow / fast,
+			            match ? "yes" : "NO");
+		}
+		fs::remove(path);
+	}
+	return mismatches == 0 ? 0 : 1;
+}
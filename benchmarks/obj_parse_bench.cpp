@@ -0,0 +1,107 @@
+// OBJ parse throughput on synthetic meshes.
+// Usage: obj_parse_bench [megabytes...]   (default: 4 16 64)
+#include "resources/MeshData.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <vector>
+
+namespace fs = std::filesystem;
+
+namespace {
+	constexpr int RUNS = 5;
+
+	// Grid of quads that exercises every face syntax the engine accepts,
+	// plus the wildcard faces and the collider lines.
+	size_t WriteSyntheticObj(const fs::path &path, size_t targetBytes) {
+		std::ofstream out(path, std::ios::binary);
+		char line[256];
+		uint32_t numVerts = 0;
+		uint32_t numUVs = 0;
+		uint32_t cell = 0;
+		while (static_cast<size_t>(out.tellp()) < targetBytes) {
+			const float x = static_cast<float>(cell % 512);
+			const float z = static_cast<float>(cell / 512);
+			const float h = 0.001f * static_cast<float>((cell * 7919) % 1000);
+			for (int i = 0; i < 4; ++i) {
+				const float dx = (i == 1 || i == 2) ? 1.0f : 0.0f;
+				const float dz = (i >= 2) ? 1.0f : 0.0f;
+				out.write(line, std::snprintf(line, sizeof(line), "v %.6f %.6f %.6f\n", x + dx, h, z + dz));
+				out.write(line, std::snprintf(line, sizeof(line), "vt %.6f %.6f\n", dx, dz));
+			}
+			numVerts += 4;
+			numUVs += 4;
+			const uint32_t a = numVerts - 3, b = numVerts - 2, c = numVerts - 1, d = numVerts;
+			const uint32_t at = numUVs - 3, bt = numUVs - 2, ct = numUVs - 1, dt = numUVs;
+			switch (cell % 6) {
+				case 0:
+					out.write(line, std::snprintf(line, sizeof(line), "f %u %u %u %u\n", a, b, c, d));
+					break;
+				case 1:
+					out.write(line, std::snprintf(line, sizeof(line), "f %u/%u %u/%u %u/%u %u/%u\n",
+					                              a, at, b, bt, c, ct, d, dt));
+					break;
+				case 2:
+					out.write(line, std::snprintf(line, sizeof(line), "f %u/%u/1 %u/%u/1 %u/%u/1\nf %u/%u/1 %u/%u/1 %u/%u/1\n",
+					                              a, at, b, bt, c, ct, c, ct, d, dt, a, at));
+					break;
+				case 3:
+					out.write(line, std::snprintf(line, sizeof(line), "f %u//1 %u//1 %u//1 %u//1\n", a, b, c, d));
+					break;
+				case 4:
+					out.write(line, std::snprintf(line, sizeof(line), "f **\nc *\n"));
+					break;
+				default:
+					out.write(line, std::snprintf(line, sizeof(line), "f %u/%u %u/%u %u/%u\nf *\n",
+					                              a, at, b, bt, c, ct));
+					break;
+			}
+			++cell;
+		}
+		return static_cast<size_t>(out.tellp());
+	}
+}
+
+int main(int argc, char **argv) {
+	std::vector<size_t> sizesMB;
+	for (int i = 1; i < argc; ++i) {
+		sizesMB.push_back(std::strtoul(argv[i], nullptr, 10));
+	}
+	if (sizesMB.empty()) {
+		sizesMB = {4, 16, 64};
+	}
+
+	const fs::path dir = fs::temp_directory_path() / "ne_obj_bench";
+	fs::create_directories(dir);
+
+	std::printf("%8s %10s %10s %10s %10s\n", "size MB", "triangles", "best ms", "MB/s", "Mtri/s");
+	for (const size_t mb: sizesMB) {
+		const fs::path path = dir / ("synthetic_" + std::to_string(mb) + "mb.obj");
+		const size_t bytes = WriteSyntheticObj(path, mb * 1024 * 1024);
+
+		double best = 1e30;
+		size_t triangles = 0;
+		for (int run = 0; run < RUNS; ++run) {
+			MeshData data;
+			const auto t0 = std::chrono::steady_clock::now();
+			if (!LoadObj(path.string(), data)) {
+				std::cerr << "failed to parse " << path << "\n";
+				return 1;
+			}
+			const auto t1 = std::chrono::steady_clock::now();
+			best = std::min(best, std::chrono::duration<double>(t1 - t0).count());
+			triangles = data.VertexCount() / 3;
+		}
+
+		const double mbRead = static_cast<double>(bytes) / (1024.0 * 1024.0);
+		std::printf("%8.1f %10zu %10.2f %10.1f %10.2f\n", mbRead, triangles, best * 1000.0, mbRead / best,
+		            static_cast<double>(triangles) / best * 1e-6);
+		fs::remove(path);
+	}
+	return 0;
+}
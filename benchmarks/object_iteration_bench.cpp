@@ -0,0 +1,238 @@
+// Per-tick iteration cost over scene objects: vector<shared_ptr<Object>> with virtual calls and
+// AsPhysical downcasts, against the flat arrays of ObjectStore. GL-free stand-ins for both layouts,
+// the per-object work (integration, world matrix reads, mvp products) matches the engine loops.
+// The store tick includes SyncTransforms, once copying every object as it used to and once
+// skipping the objects whose transform version did not change.
+// Usage: object_iteration_bench [objects]
+#include "core/math/Vector.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <memory>
+#include <random>
+#include <vector>
+
+namespace {
+	constexpr int RUNS = 9;
+	constexpr int VIEWS = 8;         // main view plus portal views rendered per frame
+	constexpr int BODY_EVERY = 10;   // one object in ten is physical
+
+	float sink = 0.0f;
+
+	// Heap layout: the scene as the engine kept it before the store
+	struct Physical;
+
+	struct Object {
+		virtual ~Object() = default;
+
+		virtual void Update() {}
+
+		virtual Physical *AsPhysical() { return nullptr; }
+
+		const Matrix4 &LocalToWorld() const { return world; }
+
+		const Matrix4 &WorldToLocal() const { return worldInv; }
+
+		// Object::UpdateWorld after a change of pos
+		void Moved() {
+			world = Matrix4::Trans(pos);
+			worldInv = Matrix4::Trans(-pos);
+			++version;
+		}
+
+		Vector3 pos{0.0f};
+		Vector3 euler{0.0f};
+		Vector3 scale{1.0f};
+		float p_scale = 1.0f;
+		Matrix4 world = Matrix4::Identity();
+		Matrix4 worldInv = Matrix4::Identity();
+		uint32_t version = 1;
+		uint32_t shader = 0;
+		uint32_t mesh = 0;
+		char payload[96]{}; // handles, names and the rest of a real object
+	};
+
+	struct Physical : Object {
+		void Update() override {
+			prev_pos = pos;
+			velocity += gravity * p_scale * (1.0f / 60.0f);
+			velocity *= (1.0f - drag);
+			pos += velocity * (1.0f / 60.0f);
+			Moved();
+		}
+
+		Physical *AsPhysical() override { return this; }
+
+		Vector3 gravity{0.0f, -9.8f, 0.0f};
+		Vector3 velocity{0.0f};
+		Vector3 prev_pos{0.0f};
+		float drag = 0.002f;
+	};
+
+	// Flat layout: what the store keeps
+	struct Renderable {
+		uint32_t shader;
+		uint32_t mesh;
+		uint32_t object;
+	};
+
+	struct Body {
+		Physical *physical;
+		uint32_t object;
+	};
+
+	// Unit box meshes, bounds as ObjectStore::Solid keeps them
+	struct Solid {
+		uint32_t object;
+		Vector3 center;
+		float radius;
+		uint32_t version;
+	};
+
+	struct Scene {
+		std::vector<Object *> store; // ObjectStore::objects, in scene order
+		std::vector<std::shared_ptr<Object>> objects;
+		std::vector<Matrix4> localToWorld;
+		std::vector<Matrix4> normalMatrix;
+		std::vector<uint32_t> versions;
+		std::vector<Renderable> renderables;
+		std::vector<Body> bodies;
+		std::vector<Solid> solids;
+	};
+
+	Scene MakeScene(int count) {
+		Scene scene;
+		std::mt19937 rng(42);
+		std::uniform_real_distribution<float> coord(-100.0f, 100.0f);
+		// Interleave other allocations so objects land scattered, as they do after level switches
+		std::vector<std::unique_ptr<char[]>> clutter;
+		for (int i = 0; i < count; ++i) {
+			std::shared_ptr<Object> object;
+			if (i % BODY_EVERY == 0) {
+				object = std::make_shared<Physical>();
+			} else {
+				object = std::make_shared<Object>();
+			}
+			object->pos = Vector3(coord(rng), coord(rng), coord(rng));
+			object->Moved();
+			object->shader = static_cast<uint32_t>(rng() % 4);
+			object->mesh = static_cast<uint32_t>(rng() % 16);
+			scene.objects.push_back(object);
+			clutter.emplace_back(new char[64 + rng() % 512]);
+		}
+		std::shuffle(scene.objects.begin(), scene.objects.end(), rng);
+
+		for (uint32_t i = 0; i < scene.objects.size(); ++i) {
+			Object *object = scene.objects[i].get();
+			scene.store.push_back(object);
+			scene.localToWorld.push_back(object->world);
+			scene.normalMatrix.push_back(object->worldInv.Transposed());
+			scene.versions.push_back(0);
+			if (Physical *physical = object->AsPhysical()) {
+				scene.bodies.push_back({physical, i});
+			} else {
+				scene.renderables.push_back({object->shader, object->mesh, i});
+				scene.solids.push_back({i, Vector3(0.0f), -1.0f, 0});
+			}
+		}
+		std::sort(scene.renderables.begin(), scene.renderables.end(), [](const Renderable &a, const Renderable &b) {
+			return a.shader != b.shader ? a.shader < b.shader : a.mesh < b.mesh;
+		});
+		return scene;
+	}
+
+	// The old Engine::Update and Render loops
+	void TickPointers(Scene &scene, const Matrix4 &viewProj) {
+		for (const auto &object: scene.objects) {
+			object->Update();
+		}
+		for (const auto &object: scene.objects) {
+			if (Physical *physical = object->AsPhysical()) {
+				sink += physical->pos.y;
+			}
+		}
+		for (int v = 0; v < VIEWS; ++v) {
+			uint32_t lastShader = ~0u;
+			for (const auto &object: scene.objects) {
+				if (object->AsPhysical()) {
+					continue;
+				}
+				lastShader = object->shader != lastShader ? object->shader : lastShader;
+				const Matrix4 mvp = viewProj * object->LocalToWorld();
+				sink += mvp.m[15] + static_cast<float>(lastShader);
+			}
+		}
+	}
+
+	// ObjectStore::SyncTransforms, with or without the version check
+	void SyncTransforms(Scene &scene, bool versioned) {
+		for (size_t i = 0; i < scene.store.size(); ++i) {
+			const Object *object = scene.store[i];
+			if (versioned && object->version == scene.versions[i]) {
+				continue;
+			}
+			scene.versions[i] = object->version;
+			scene.localToWorld[i] = object->LocalToWorld();
+			scene.normalMatrix[i] = object->WorldToLocal().Transposed();
+		}
+		for (Solid &solid: scene.solids) {
+			if (versioned && solid.radius >= 0.0f && solid.version == scene.versions[solid.object]) {
+				continue;
+			}
+			const Matrix4 &m = scene.localToWorld[solid.object];
+			solid.center = m.MulPoint(Vector3(0.0f));
+			solid.radius = std::sqrt(3.0f) * std::sqrt(std::max({m.XAxis().MagSq(), m.YAxis().MagSq(),
+			                                                      m.ZAxis().MagSq()}));
+			solid.version = scene.versions[solid.object];
+		}
+	}
+
+	// The same work walking the store arrays
+	void TickStore(Scene &scene, const Matrix4 &viewProj, bool versioned) {
+		for (const Body &body: scene.bodies) {
+			body.physical->Update();
+		}
+		for (const Body &body: scene.bodies) {
+			sink += body.physical->pos.y;
+		}
+		SyncTransforms(scene, versioned);
+		for (int v = 0; v < VIEWS; ++v) {
+			uint32_t lastShader = ~0u;
+			for (const Renderable &r: scene.renderables) {
+				lastShader = r.shader != lastShader ? r.shader : lastShader;
+				const Matrix4 mvp = viewProj * scene.localToWorld[r.object];
+				sink += mvp.m[15] + static_cast<float>(lastShader);
+			}
+		}
+	}
+
+	template<typename F>
+	double Best(F &&f) {
+		double best = 1e30;
+		for (int run = 0; run < RUNS; ++run) {
+			const auto t0 = std::chrono::steady_clock::now();
+			f();
+			const auto t1 = std::chrono::steady_clock::now();
+			best = std::min(best, std::chrono::duration<double, std::milli>(t1 - t0).count());
+		}
+		return best;
+	}
+}
+
+int main(int argc, char **argv) {
+	const int maxCount = argc > 1 ? std::atoi(argv[1]) : 10000;
+	const Matrix4 viewProj = Matrix4::Scale(Vector3(0.6f, 1.0f, -0.02f)) * Matrix4::Trans(Vector3(0, 0, -5));
+
+	std::printf("%8s %12s %14s %15s %8s\n", "objects", "pointers ms", "store all ms", "store moved ms",
+	            "speedup");
+	for (int count = 100; count <= maxCount; count *= 10) {
+		Scene scene = MakeScene(count);
+		const double pointers = Best([&] { TickPointers(scene, viewProj); });
+		const double all = Best([&] { TickStore(scene, viewProj, false); });
+		const double moved = Best([&] { TickStore(scene, viewProj, true); });
+		std::printf("%8d %12.3f %14.3f %15.3f %7.1fx\n", count, pointers, all, moved, pointers / moved);
+	}
+	return sink == 12345.0f ? 1 : 0;
+}
@@ -10,6 +10,10 @@
 #include "game/Scene.h"
 #include "game/objects/environment/Sky.h"
 #include "game/LevelManager.h"
+#include "game/ObjectStore.h"
+#include "game/PortalGraph.h"
+#include "rendering/FrameBuffer.h"
+#include "rendering/ViewSet.h"
 #include <GL/glew.h>
 
 #if defined(_WIN32)
@@ -25,27 +29,34 @@
 
 class InputAdapter;
 
+class DebugLines;
+
+class LayeredFrameBuffer;
+
 class Engine {
 public:
-	Engine();
+	// A benchmark engine preloads no level and drops the levels it leaves instead of keeping them
+	explicit Engine(bool benchmark = false);
 
 	~Engine();
 
 	int Run();
 
-	void Update() const;
+	// Load each level and time its load, simulation ticks and frames, then exit
+	int RunBenchmark(const std::vector<std::string> &levelPaths);
+
+	void Update();
 
 	void Render(const Camera &cam, GLuint curFBO, const Portal *skipPortal) const;
 
-	void LoadScene(const std::string &levelName);
+	// Render every portal view of a recursion depth in one layered pass.
+	// Returns false when the views do not fit and the classic path must be used.
+	bool RenderMultiview(const Camera &cam);
 
-	void AddPortal(const std::shared_ptr<Portal> &portal) {
-		vPortals.push_back(portal);
-	}
+	void LoadScene(const std::string &levelName);
 
-	void AddPortalConnection(const std::shared_ptr<Portal> &portal, const std::string &targetTunnel, int targetDoor) {
-		pendingPortalConnections.push_back({portal, targetTunnel, targetDoor});
-	}
+	// Throw props out of the player's view into the running level, alternating crates and balls
+	void SpawnProps(int count);
 
 #if defined(_WIN32)
 	LRESULT WindowProc(HWND hCurWnd, UINT uMsg, WPARAM wParam, LPARAM lParam);
@@ -55,6 +66,10 @@ public:
 
 	[[nodiscard]] float NearestPortalDist() const;
 
+	// Target of the portal views drawn with depth levels of recursion left, shared by every portal:
+	// a portal renders into it and samples it right away, before the next one reuses it
+	[[nodiscard]] const FrameBuffer &PortalBuffer(int depth) const { return *portalBuffers[depth - 1]; }
+
 
 private:
 	static bool InitOSWrapper();
@@ -77,6 +92,25 @@ private:
 
 	void PeriodicRender(int64_t &cur_ticks);
 
+	void RenderFrame();
+
+	// Rebuild vObjects, vPortals and their indices from the running level
+	void GatherLevelObjects();
+
+	// Release the running level and everything indexing it, for benchmarks
+	void DropLevel();
+
+	// Process totals next to the share of the running level
+	void PrintMemory(const std::string &title) const;
+
+	// Release the resources no built level uses, if they exceed GH_RESOURCE_BUDGET_MB
+	void TrimLevelResources();
+
+	// Patch the running level when its YAML was saved
+	void ReloadLevelIfChanged();
+
+	void RenderViews(const ViewSet &views, const std::vector<int> &portalLayers, const LayeredFrameBuffer *src);
+
 	static void EnableVSync();
 
 #if defined(_WIN32)
@@ -100,26 +134,39 @@ private:
     bool isGood = false; // initialized without problems
     bool isWindowGood = false; // window successfully created and initialized
     bool isFullscreen; // fullscreen state
+	bool benchmark; // timing levels with RunBenchmark, nothing is preloaded or kept
 
 	Camera main_cam;
 	Input input;
 	Timer timer;
 
-	struct PortalConnection {
-		std::shared_ptr<Portal> portal;
-		std::string targetTunnel;
-		int targetDoor;
-	};
-
-	std::vector<PortalConnection> pendingPortalConnections;
 	std::vector<std::shared_ptr<Object> > vObjects;
 	std::vector<std::shared_ptr<Portal> > vPortals;
 	std::shared_ptr<Sky> sky;
 	std::shared_ptr<Player> player;
+	// Flat view of vObjects for the update, collision and draw loops
+	ObjectStore store;
+	PortalGraph portalGraph;
+	// Portals this frame can draw at any depth, recursive passes skip the others
+	PortalGraph::PortalMask frameReach = ~PortalGraph::PortalMask(0);
 
 	GLint occlusionCullingSupported{};
 
+	bool showColliders = false;
+	std::unique_ptr<DebugLines> debugLines;
+
+	bool multiviewSupported = false;
+	bool useMultiview = false;
+	ViewSet mvViews[GH_MAX_RECURSION];
+	// Per depth, layer sampled by portal p in view v at [p * GH_MULTIVIEW_MAX_VIEWS + v]
+	std::vector<int> mvPortalLayers[GH_MAX_RECURSION];
+	std::unique_ptr<LayeredFrameBuffer> mvBuffers[GH_MAX_RECURSION - 1];
+	std::unique_ptr<FrameBuffer> portalBuffers[GH_MAX_RECURSION - 1];
+
 	LevelManager levelManager;
 	std::shared_ptr<Scene> curScene = nullptr;
+	// The running level, its objects and portals are gathered into vObjects and vPortals
+	std::shared_ptr<Level> curLevel;
+	std::string curLevelName;
 	std::unique_ptr<InputAdapter> inputAdapter;
 };
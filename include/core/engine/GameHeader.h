@@ -1,5 +1,6 @@
 #pragma once
 
+#include <cstddef>
 #include <cstdint>
 
 //Windows
@@ -24,6 +25,26 @@ static constexpr float GH_NEAR_MAX = 1e-1f;
 static constexpr float GH_FAR = 100.0f;
 static constexpr int GH_FBO_SIZE = 2048;
 static constexpr int GH_MAX_RECURSION = 4;
+static constexpr bool GH_USE_MULTIVIEW = false;
+static constexpr int GH_MULTIVIEW_MAX_VIEWS = 16; // must match MAX_VIEWS in the *_mv shaders
+static constexpr bool GH_USE_COMPILED_MESHES = true;
+static constexpr bool GH_USE_COMPILED_LEVELS = true;
+static constexpr bool GH_KEEP_MESH_CPU_DATA = false; // keep the vertex arrays of OBJ meshes after upload
+static constexpr bool GH_USE_COMPRESSED_TEXTURES = true; // .dds next to the .bmp, if up to date
+static constexpr bool GH_PACK_LEVEL_TEXTURES = true; // one texture array per level
+static constexpr bool GH_ASYNC_LOADING = true;
+static constexpr int GH_LOADER_THREADS = 2;
+static constexpr float GH_LOADER_BUDGET_MS = 2.0f; // GL uploads per frame
+static constexpr bool GH_PRELOAD_LEVELS = true;
+static constexpr bool GH_LEVEL_HOT_RELOAD = true; // patch the running level when its YAML is saved
+static constexpr size_t GH_KEPT_LEVELS = 8; // built levels kept after leaving them
+static constexpr size_t GH_RESOURCE_BUDGET_MB = 256; // meshes and textures no level uses are trimmed past this
+static constexpr size_t GH_LEVEL_ARENA_BLOCK = 64 * 1024; // first block of a level arena, later ones grow
+static constexpr bool GH_USE_SHADER_CACHE = true;
+static constexpr bool GH_SHADER_HOT_RELOAD = true; // watch assets/shaders for changes
+static constexpr char GH_SHADER_CACHE_DIR[] = "cache/shaders/";
+static constexpr int GH_BENCH_TICKS = 500; // per level with --bench
+static constexpr int GH_BENCH_FRAMES = 100;
 
 //Gameplay
 static constexpr float GH_MOUSE_SENSITIVITY = 0.005f;
@@ -39,6 +60,14 @@ static constexpr int GH_MAX_STEPS = 30;
 static constexpr float GH_PLAYER_HEIGHT = 1.5f;
 static constexpr float GH_PLAYER_RADIUS = 0.2f;
 static constexpr float GH_GRAVITY = -9.8f;
+static constexpr float GH_PROP_CRATE_BOUNCE = 0.1f;
+static constexpr float GH_PROP_CRATE_FRICTION = 0.05f;
+static constexpr float GH_PROP_BALL_BOUNCE = 0.8f;
+static constexpr float GH_PROP_BALL_FRICTION = 0.005f;
+static constexpr float GH_PROP_DRAG = 0.0005f;
+static constexpr float GH_PROP_SIZE = 0.1f; // half extent of a spawned prop
+static constexpr int GH_PROP_SPAWN_COUNT = 64; // props thrown per spawn key press
+static constexpr float GH_PROP_SPAWN_SPEED = 4.0f;
 
 //Global variables
 class Engine;
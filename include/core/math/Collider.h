@@ -1,14 +1,17 @@
 #pragma once
 #include "Vector.h"
-#include "core/camera/Camera.h"
 
 class Collider {
 public:
   Collider(const Vector3& a, const Vector3& b, const Vector3& c);
 
+  // Rebuild from a matrix previously returned by Matrix()
+  explicit Collider(const Matrix4& mat) : mat(mat) {}
+
   bool Collide(const Matrix4& localToWorld, Vector3& delta) const;
 
-  void DebugDraw(const Camera& cam, const Matrix4& objMat) const;
+  // Maps the unit square [-1, 1]^2 onto the collider rectangle in local space
+  [[nodiscard]] const Matrix4& Matrix() const { return mat; }
 
 private:
   void CreateSorted(const Vector3& da, const Vector3& c, const Vector3& db);
@@ -0,0 +1,48 @@
+#pragma once
+
+#include <compare>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <string_view>
+
+// Interned string: every equal string maps to the same 32-bit id for the whole run, so
+// comparing and hashing atoms are integer operations. Ids are dense and 0 is the empty string.
+// The text is stored once and never freed. Interning is thread safe, levels are parsed on
+// loader threads. Ids are not stable across runs, files store the text.
+class Atom {
+public:
+	Atom() = default;
+
+	// Hashes str once, copying it only the first time it is seen
+	explicit Atom(std::string_view str);
+
+	// The atom of str if it was interned already, the empty atom otherwise. Never inserts.
+	[[nodiscard]] static Atom Find(std::string_view str);
+
+	[[nodiscard]] uint32_t Id() const { return id; }
+
+	// Null terminated, valid until exit
+	[[nodiscard]] std::string_view View() const;
+
+	[[nodiscard]] const char *CStr() const { return View().data(); }
+
+	[[nodiscard]] bool Empty() const { return id == 0; }
+
+	bool operator==(const Atom &other) const = default;
+
+	auto operator<=>(const Atom &other) const = default;
+
+	// Number of distinct strings interned so far, the empty one included
+	[[nodiscard]] static size_t Count();
+
+private:
+	explicit Atom(uint32_t id) : id(id) {}
+
+	uint32_t id = 0;
+};
+
+template<>
+struct std::hash<Atom> {
+	size_t operator()(const Atom &atom) const noexcept { return atom.Id(); }
+};
@@ -0,0 +1,43 @@
+#pragma once
+
+#include <atomic>
+#include <filesystem>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+// Watches one directory on a background thread and collects the names of the files
+// written in it. Uses inotify on Linux, elsewhere the thread polls the timestamps.
+class FileWatcher {
+public:
+	explicit FileWatcher(std::string directory);
+
+	~FileWatcher();
+
+	// Move the file names changed since the last call into changed, without locking if there are none
+	void Poll(std::vector<std::string> &changed);
+
+	FileWatcher(const FileWatcher &) = delete;
+
+	FileWatcher &operator=(const FileWatcher &) = delete;
+
+private:
+	void Run();
+
+	void Post(std::string file);
+
+	// Timestamp scan for platforms without inotify, returns the files that changed.
+	// The initial scan only records what is already there.
+	std::vector<std::string> Scan(bool initial);
+
+	std::string directory;
+	std::unordered_map<std::string, std::filesystem::file_time_type> timestamps;
+	std::thread thread;
+	std::atomic<bool> stopping{false};
+	std::atomic<bool> dirty{false};
+	std::mutex mutex;
+	std::vector<std::string> pending;
+	int inotifyFd = -1;
+};
@@ -0,0 +1,40 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+
+// FNV-1a hashing, usable at compile time for string literals
+static constexpr uint64_t GH_FNV64_OFFSET = 0xcbf29ce484222325ull;
+static constexpr uint64_t GH_FNV64_PRIME = 0x100000001b3ull;
+
+inline uint64_t HashFNV64(const void *data, size_t size, uint64_t seed = GH_FNV64_OFFSET) {
+	const auto *bytes = static_cast<const unsigned char *>(data);
+	uint64_t h = seed;
+	for (size_t i = 0; i < size; ++i) {
+		h ^= bytes[i];
+		h *= GH_FNV64_PRIME;
+	}
+	return h;
+}
+
+constexpr uint64_t HashFNV64(std::string_view str, uint64_t seed = GH_FNV64_OFFSET) {
+	uint64_t h = seed;
+	for (const char c: str) {
+		h ^= static_cast<unsigned char>(c);
+		h *= GH_FNV64_PRIME;
+	}
+	return h;
+}
+
+static constexpr uint32_t GH_FNV32_OFFSET = 0x811c9dc5u;
+static constexpr uint32_t GH_FNV32_PRIME = 0x01000193u;
+
+constexpr uint32_t HashFNV32(std::string_view str, uint32_t seed = GH_FNV32_OFFSET) {
+	uint32_t h = seed;
+	for (const char c: str) {
+		h ^= static_cast<unsigned char>(c);
+		h *= GH_FNV32_PRIME;
+	}
+	return h;
+}
@@ -0,0 +1,35 @@
+#pragma once
+
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Fixed set of worker threads consuming a FIFO of jobs
+class ThreadPool {
+public:
+	explicit ThreadPool(unsigned int numThreads);
+
+	// Waits for the running jobs, queued jobs are dropped
+	~ThreadPool();
+
+	void Submit(std::function<void()> job);
+
+	[[nodiscard]] unsigned int NumThreads() const { return static_cast<unsigned int>(workers.size()); }
+
+	// Delete copy constructor and assignment operator
+	ThreadPool(const ThreadPool &) = delete;
+
+	ThreadPool &operator=(const ThreadPool &) = delete;
+
+private:
+	void WorkerLoop();
+
+	std::vector<std::thread> workers;
+	std::deque<std::function<void()>> jobs;
+	std::mutex mutex;
+	std::condition_variable wake;
+	bool stopping = false;
+};
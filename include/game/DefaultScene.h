@@ -4,7 +4,7 @@
 
 class DefaultScene : public Scene {
 public:
-	void Load(const LevelConfig &config, PObjectVec &objs, PPortalVec &portals, Player &player) override;
+	void Load(const LevelConfig &config, Level &level) override;
 
 	void Unload() override;
 };
\ No newline at end of file
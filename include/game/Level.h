@@ -0,0 +1,44 @@
+#pragma once
+
+#include "core/math/Vector.h"
+#include "game/LevelArena.h"
+#include "game/LevelConfig.h"
+#include "game/objects/base/Object.h"
+#include "game/objects/interactive/Portal.h"
+#include "rendering/MemoryStats.h"
+#include <string>
+
+// What one LevelConfig object was built into, object is null if it could not be built
+struct LevelObject {
+	std::shared_ptr<Object> object;
+	PPortalVec portals;
+};
+
+// A fully built level, ready to be swapped into the engine
+struct Level {
+	// Declared first, so it goes after the objects built in it
+	LevelArena arena;
+
+	std::string name;
+	Vector3 playerStart{0.0f};
+	// The config the level was built from and, in the same order, what each object became.
+	// Hot reload diffs a new config against these.
+	LevelConfig config;
+	std::vector<LevelObject> entries;
+	// Added while playing, see Engine::SpawnProps. Hot reload leaves them alone.
+	PObjectVec spawned;
+
+	// Append every built object and portal
+	void Gather(PObjectVec &objects, PPortalVec &portals) const;
+
+	// Put every packable texture of the level into one texture array, the objects
+	// that used them switch to texture_layer and select their layer per draw
+	void PackTextures();
+
+	// Mark the meshes and textures of the level as used, see TrimResources
+	void TouchResources() const;
+
+	// Memory of the meshes and textures the level uses, one entry per MemoryStats class. Resources
+	// shared with other levels count in each of them. Portal framebuffers belong to the engine.
+	void MemoryUsage(MemoryStats::Usage usage[MemoryStats::NUM_CLASSES]) const;
+};
@@ -0,0 +1,54 @@
+#pragma once
+
+#include <cstddef>
+#include <memory>
+#include <memory_resource>
+
+// Owns the memory of everything a level builds: objects, portals and their control blocks.
+// Allocations are bumped out of a few large blocks and nothing is freed one by one,
+// the blocks go back in one go when the level is dropped. Not thread safe, levels are built
+// on the main thread. Whatever lives here must not outlive the Level that owns the arena.
+class LevelArena : public std::pmr::memory_resource {
+public:
+	LevelArena();
+
+	LevelArena(const LevelArena &) = delete;
+
+	LevelArena &operator=(const LevelArena &) = delete;
+
+	template<typename T, typename... Args>
+	std::shared_ptr<T> Make(Args &&... args) {
+		return std::allocate_shared<T>(std::pmr::polymorphic_allocator<T>(this), std::forward<Args>(args)...);
+	}
+
+	// Allocations served since the arena was created, and the bytes they asked for
+	[[nodiscard]] size_t Allocations() const { return allocations; }
+
+	[[nodiscard]] size_t Bytes() const { return bytes; }
+
+	// Blocks taken from the heap to serve them
+	[[nodiscard]] size_t Blocks() const { return upstream.blocks; }
+
+private:
+	// Counts the blocks the monotonic buffer asks for
+	struct Upstream : std::pmr::memory_resource {
+		size_t blocks = 0;
+
+		void *do_allocate(size_t size, size_t align) override;
+
+		void do_deallocate(void *p, size_t size, size_t align) override;
+
+		[[nodiscard]] bool do_is_equal(const memory_resource &other) const noexcept override { return this == &other; }
+	};
+
+	void *do_allocate(size_t size, size_t align) override;
+
+	void do_deallocate(void *, size_t, size_t) override {}
+
+	[[nodiscard]] bool do_is_equal(const memory_resource &other) const noexcept override { return this == &other; }
+
+	Upstream upstream;
+	std::pmr::monotonic_buffer_resource buffer;
+	size_t allocations = 0;
+	size_t bytes = 0;
+};
@@ -1,27 +1,72 @@
 #pragma once
 
-#include <yaml-cpp/yaml.h>
-#include <unordered_map>
+#include "core/util/Atom.h"
+#include <cstdint>
 #include <string>
+#include <type_traits>
+#include <vector>
 
+enum class ObjectType : uint8_t {
+	Tunnel,
+	Ground,
+	Prop
+};
+
+const char *ObjectTypeName(ObjectType type);
+
+// Door of another object this door leads to, resolved when the level is parsed
+struct PortalLink {
+	uint8_t door;         // 1 or 2
+	uint8_t targetDoor;
+	uint16_t targetObject; // index in LevelConfig::objects
+};
+
+// Fixed-size record, stored as is in compiled levels
 struct ObjectConfig {
-	std::string type;
-	std::string subtype;
-	std::string id;
-	std::vector<float> position;
-	std::vector<float> scale;
-	std::vector<float> rotation;
-	std::vector<YAML::Node> portals;
+	static constexpr int MAX_PORTALS = 2;
+
+	ObjectType type;
+	uint8_t subtype;     // Tunnel::Type, Prop::Type, or 1 for a sloped Ground
+	uint8_t portalCount;
+	uint8_t reserved;
+	uint32_t id;         // index in LevelConfig::strings, 0 is the empty id
+	float position[3];
+	float scale[3];
+	float rotation[3];
+	PortalLink portals[MAX_PORTALS];
 };
 
+static_assert(std::is_trivially_copyable_v<ObjectConfig> && sizeof(ObjectConfig) == 52, "ObjectConfig layout");
+
+// A level description, either parsed from its YAML file or read from the compiled
+// .nlevel file the level_compiler tool writes next to it
 class LevelConfig {
 public:
-	explicit LevelConfig(const std::string &yamlPath);
+	static constexpr uint32_t MAGIC = 0x564C454E; // "NELV"
+	static constexpr uint32_t VERSION = 1;
+
+	// The compiled level if it is up to date, the YAML otherwise. Throws if neither can be read.
+	static LevelConfig Load(const std::string &yamlPath);
+
+	// Problems are reported in errors, broken objects and links are skipped
+	static LevelConfig FromYAML(const std::string &yamlPath, std::vector<std::string> &errors);
+
+	// Checks that need the whole level: finite transforms, non-zero scales, reciprocal links
+	void Validate(std::vector<std::string> &errors) const;
+
+	// The whole file is read with a single call
+	static bool FromBinary(const std::string &path, LevelConfig &config);
+
+	bool WriteBinary(const std::string &path) const;
+
+	static std::string BinaryPathFor(const std::string &yamlPath);
+
+	static bool IsUpToDate(const std::string &yamlPath, const std::string &binPath);
+
+	[[nodiscard]] Atom Id(const ObjectConfig &object) const { return strings[object.id]; }
 
 	std::string name;
-	std::vector<float> player_start;
+	float player_start[3]{};
 	std::vector<ObjectConfig> objects;
-
-private:
-	void ParseYAML(const YAML::Node &root);
+	std::vector<Atom> strings{Atom()}; // object ids, the compiled file stores their text
 };
@@ -1,7 +1,14 @@
 #pragma once
 
 #include "LevelConfig.h"
+#include "core/util/FileWatcher.h"
+#include "game/Level.h"
+#include <future>
+#include <memory>
 #include <unordered_map>
+#include <vector>
+
+class Scene;
 
 class LevelManager {
 public:
@@ -9,6 +16,49 @@ public:
 
 	LevelConfig LoadConfig(const std::string &levelName);
 
+	[[nodiscard]] const std::vector<std::string> &RegisteredLevels() const { return levelNames; }
+
+	// Start parsing a level in the background, it is built later by Update
+	void Preload(const std::string &levelName);
+
+	// Build at most one preloaded level whose YAML is ready, call once per frame
+	void Update(Scene &scene);
+
+	// Preloaded level, waiting for its YAML if needed. Null if it was never preloaded.
+	std::shared_ptr<Level> Take(const std::string &levelName, Scene &scene);
+
+	// Parse and build synchronously
+	std::shared_ptr<Level> Build(const std::string &levelName, Scene &scene);
+
+	// Keep a built level around so switching back to it is immediate. Past GH_KEPT_LEVELS the one
+	// left longest ago is dropped, its resources stay pooled until TrimResources needs the room.
+	void Keep(const std::shared_ptr<Level> &level, const std::string &levelName);
+
+	// Mark the resources of every built level as used
+	void TouchResources() const;
+
+	[[nodiscard]] bool IsPreloaded(const std::string &levelName) const;
+
+	// Drop every preloaded level, waiting for the ones still parsing
+	void Clear();
+
+	// Whether the YAML of the active level was written since the last call. Preloaded copies
+	// of other levels written meanwhile are dropped, so they are built again from the new file.
+	bool PollChanged(const std::string &activeLevel);
+
+	// Parse the level YAML again and patch the built level to match, false if the new file has errors
+	bool Reload(const std::string &levelName, Level &level, Scene &scene);
+
 private:
+	static std::shared_ptr<Level> BuildFromConfig(const LevelConfig &config, Scene &scene);
+
 	std::unordered_map<std::string, std::string> levelPaths;
+	std::vector<std::string> levelNames;
+	std::unordered_map<std::string, std::future<LevelConfig>> parsing;
+	std::unordered_map<std::string, std::shared_ptr<Level>> ready;
+	std::vector<std::string> kept; // levels given to Keep, oldest first
+
+	std::unique_ptr<FileWatcher> watcher;
+	std::string watchedDir;
+	std::vector<std::string> changedFiles;
 };
@@ -1,9 +1,16 @@
 #pragma once
 
+#include "game/LevelArena.h"
 #include "game/objects/base/Object.h"
+#include "game/objects/interactive/Portal.h"
 #include "LevelConfig.h"
 
 class ObjectFactory {
 public:
-	static std::shared_ptr<Object> Create(const ObjectConfig &config);
+	// Portals created along with the object are appended to portals, id names them.
+	// The object and its portals are allocated in arena.
+	static std::shared_ptr<Object> Create(const ObjectConfig &config, Atom id, LevelArena &arena, PPortalVec &portals);
+
+	// Apply the transform of config to an object it created, and place its portals again
+	static void Place(const ObjectConfig &config, Object &object, const PPortalVec &portals);
 };
\ No newline at end of file
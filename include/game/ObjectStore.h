@@ -0,0 +1,107 @@
+#pragma once
+
+#include "core/math/Vector.h"
+#include "game/objects/base/Object.h"
+#include "resources/ResourcePool.h"
+#include <cstdint>
+#include <vector>
+
+//Forward declarations
+class Camera;
+
+class DebugLines;
+
+class Mesh;
+
+class Physical;
+
+class Shader;
+
+class Texture;
+
+class ViewSet;
+
+// Flat arrays over the objects of the running level, walked by the loops that visit every object
+// each tick or view. The objects keep owning their state and stay the interface for game code,
+// the store indexes them by role and mirrors their transforms into contiguous matrices.
+// Rebuilt when the object list changes, transforms are mirrored once per tick by SyncTransforms.
+class ObjectStore {
+public:
+	// Drawn with Object's default path, sorted by shader and texture so consecutive draws share state
+	struct Renderable {
+		Handle<Shader> shader;
+		Handle<Texture> texture;
+		Handle<Mesh> mesh;
+		int layer;
+		uint32_t object;
+	};
+
+	struct Body {
+		Physical *physical;
+		uint32_t object;
+		uint32_t firstSphere;
+		uint32_t sphereCount;
+		float radius; // local space sphere around every hit sphere
+	};
+
+	// Hit spheres of every body, flattened
+	struct HitSphere {
+		Matrix4 localToUnit;
+		uint32_t body;
+	};
+
+	// Static objects with a mesh, whose colliders the bodies are tested against
+	struct Solid {
+		Object *object;
+		uint32_t index;
+		// World space sphere around the mesh bounds, radius < 0 until the mesh is resident
+		Vector3 center;
+		float radius;
+		uint32_t version; // transform version the bounds were computed at
+	};
+
+	void Build(const PObjectVec &objects);
+
+	void Clear();
+
+	// Copy the cached world matrices of the objects that moved into the store arrays, and refresh
+	// their solid bounds. Static objects cost a version check.
+	void SyncTransforms();
+
+	// Whether no solid is still waiting for its mesh, so its colliders are known.
+	// Meshes that failed to load do not count.
+	[[nodiscard]] bool SolidsLoaded() const;
+
+	// Bounding sphere test, true while the solid bounds are unknown
+	[[nodiscard]] static bool MayCollide(const Body &body, const Solid &solid);
+
+	void Draw(const Camera &cam) const;
+
+	// Draw once per view of a layered pass, with the <shader>_mv variants
+	void DrawViews(const ViewSet &views);
+
+	void DebugDraw(DebugLines &lines) const;
+
+	[[nodiscard]] const std::vector<Body> &Bodies() const { return bodies; }
+
+	[[nodiscard]] const std::vector<HitSphere> &HitSpheres() const { return hitSpheres; }
+
+	[[nodiscard]] const std::vector<Solid> &Solids() const { return solids; }
+
+	[[nodiscard]] size_t Size() const { return objects.size(); }
+
+private:
+	std::vector<Object *> objects;
+
+	// Per object, indexed like objects
+	std::vector<Matrix4> localToWorld;
+	std::vector<Matrix4> normalMatrix; // WorldToLocal transposed, the mv uniform
+	std::vector<uint32_t> versions;    // TransformVersion the matrices were copied at, 0 before the first copy
+
+	std::vector<Renderable> renderables;
+	// Per renderable, the _mv variant of its shader, resolved on first layered draw
+	std::vector<Handle<Shader>> mvShaders;
+	std::vector<Body> bodies;
+	std::vector<HitSphere> hitSpheres;
+	std::vector<Solid> solids;
+};
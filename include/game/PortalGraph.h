@@ -0,0 +1,59 @@
+#pragma once
+
+#include "core/engine/GameHeader.h"
+#include "core/util/Atom.h"
+#include "game/objects/interactive/Portal.h"
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+class Camera;
+
+// Connectivity of the level portals, built when a level is swapped in.
+// Besides the lookups it keeps, per portal, which other portals can show up behind it,
+// so recursive passes only visit the portals a view through it can actually reach.
+class PortalGraph {
+public:
+	static_assert(GH_MAX_PORTALS <= 64, "portal sets are 64-bit masks");
+	using PortalMask = uint64_t;
+
+	// Problems with the links (unconnected doors, one-way links) are appended to errors
+	void Build(const PPortalVec &portals, std::vector<std::string> &errors);
+
+	void Clear();
+
+	// Recompute the visibility sets if any portal moved since the last build
+	void Refresh();
+
+	// Portal index in the vector given to Build, -1 if unknown
+	[[nodiscard]] int IndexOf(const Portal *portal) const;
+
+	// Door of a tunnel, by level id
+	[[nodiscard]] const Portal *Find(Atom tunnel, int door) const;
+
+	// Portals a camera looking out of exit can see, everything if exit is null
+	[[nodiscard]] PortalMask VisibleThrough(const Portal *exit, const Camera &cam) const;
+
+	// Whether to can be drawn at most depth recursions after looking into from
+	[[nodiscard]] bool Reachable(const Portal *from, const Portal *to, int depth) const;
+
+	// Portals a frame rendered from cam with depth recursion levels can draw at all: those in its
+	// frustum and what is reachable through them. Recursive passes cull the rest.
+	[[nodiscard]] PortalMask ReachableFrom(const Camera &cam, int depth) const;
+
+	[[nodiscard]] size_t Size() const { return portals.size(); }
+
+private:
+	void ComputeVisibility();
+
+	std::vector<const Portal *> portals;
+	std::unordered_map<const Portal *, uint32_t> indices;
+	std::unordered_map<uint64_t, uint32_t> doors; // tunnel atom and door number
+	std::vector<uint32_t> versions;
+
+	// Per portal, the portals with a corner beyond it, seen from its front [0] or back [1] side
+	std::vector<PortalMask> beyond[2];
+	// reach[d][i]: portals drawable within d + 1 recursions after looking into portal i
+	std::vector<PortalMask> reach[GH_MAX_RECURSION];
+};
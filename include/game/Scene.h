@@ -1,13 +1,25 @@
 #pragma once
 
 #include "LevelConfig.h"
-#include "game/objects/interactive/Player.h"
+#include "game/Level.h"
 
 class Scene {
 public:
 	virtual ~Scene() = default;
 
-	virtual void Load(const LevelConfig &config, PObjectVec &objs, PPortalVec &portals, Player &player) = 0;
+	// Build the objects and portals of a level, without touching the engine state
+	virtual void Load(const LevelConfig &config, Level &level) = 0;
+
+	// Bring a built level in line with a new config. Objects are matched by id: unchanged ones
+	// are kept with their resources and portal buffers, moved ones are placed again, and only
+	// new objects or objects whose type changed are built. Links are reconnected where they differ.
+	virtual void Reload(const LevelConfig &config, Level &level);
 
 	virtual void Unload() {}
-};
\ No newline at end of file
+
+protected:
+	static void BuildObject(const LevelConfig &config, size_t index, LevelArena &arena, LevelObject &entry);
+
+	// Connect the portals of every entry as config says, leaving the links already in place alone
+	static void ConnectPortals(Level &level);
+};
@@ -4,6 +4,7 @@
 #include "core/math/Vector.h"
 #include "core/camera/Camera.h"
 #include "game/objects/props/Sphere.h"
+#include "resources/ResourcePool.h"
 #include <vector>
 #include <memory>
 
@@ -16,11 +17,18 @@ class Texture;
 
 class Shader;
 
+class DebugLines;
+
 class Object {
 public:
 	Object();
 
-	virtual ~Object() = default;
+	virtual ~Object();
+
+	// Parent and children point at each other
+	Object(const Object &) = delete;
+
+	Object &operator=(const Object &) = delete;
 
 	virtual void Reset();
 
@@ -35,11 +43,23 @@ public:
 
 	[[nodiscard]] const Physical *AsPhysical() const { return const_cast<Object *>(this)->AsPhysical(); }
 
-	void DebugDraw(const Camera &cam) const;
+	void DebugDraw(DebugLines &lines) const;
+
+	// Scene graph: pos, euler and scale are relative to the parent when there is one.
+	// The parent must outlive the link, destroying either side detaches them.
+	void SetParent(Object *newParent);
+
+	[[nodiscard]] Object *Parent() const { return parent; }
+
+	[[nodiscard]] const std::vector<Object *> &Children() const { return children; }
+
+	// Cached, rebuilt only when the local transform or one of the ancestors changed
+	[[nodiscard]] const Matrix4 &LocalToWorld() const;
 
-	[[nodiscard]] Matrix4 LocalToWorld() const;
+	[[nodiscard]] const Matrix4 &WorldToLocal() const;
 
-	[[nodiscard]] Matrix4 WorldToLocal() const;
+	// Bumped every time the world matrices are rebuilt
+	[[nodiscard]] uint32_t TransformVersion() const;
 
 	[[nodiscard]] Vector3 Forward() const;
 
@@ -50,9 +70,32 @@ public:
 	// Physical scale, only updated by portal scale changes
 	float p_scale;
 
-	std::shared_ptr<Mesh> mesh;
-	std::shared_ptr<Texture> texture;
-	std::shared_ptr<Shader> shader;
+	Handle<Mesh> mesh;
+	Handle<Texture> texture;
+	// Layer of texture to sample when it is a packed level array, -1 otherwise
+	int textureLayer{-1};
+	Handle<Shader> shader;
+	Handle<Shader> mvShader;
+
+private:
+	// Local transform the cached matrices were built from
+	struct LocalPose {
+		Vector3 pos;
+		Vector3 euler;
+		Vector3 scale;
+		float p_scale;
+	};
+
+	void UpdateWorld() const;
+
+	Object *parent{nullptr};
+	std::vector<Object *> children;
+
+	mutable Matrix4 world;
+	mutable Matrix4 worldInv;
+	mutable LocalPose pose{};
+	mutable uint32_t version{0};
+	mutable bool dirty{true};
 };
 
 typedef std::vector<std::shared_ptr<Object>> PObjectVec;
@@ -6,13 +6,12 @@
 class Ground : public Object {
 public:
 	explicit Ground(bool slope = false) {
-		if (slope) {
-			mesh = AcquireMesh("ground_slope.obj");
-		} else {
-			mesh = AcquireMesh("ground.obj");
-		}
-		shader = AcquireShader("texture");
-		texture = AcquireTexture("floor.bmp");
+		// Interned once, a level builds many grounds
+		static const Atom MESH("ground.obj"), SLOPE_MESH("ground_slope.obj");
+		static const Atom SHADER("texture"), TEXTURE("floor.bmp");
+		mesh = AcquireMesh(slope ? SLOPE_MESH : MESH);
+		shader = AcquireShader(SHADER);
+		texture = AcquireTexture(TEXTURE);
 		scale = Vector3(1, 1, 1);
 	}
 };
@@ -1,5 +1,7 @@
 #pragma once
 
+#include "rendering/GLState.h"
+#include "rendering/ViewSet.h"
 #include "resources/Resources.h"
 #include "core/math/Vector.h"
 
@@ -8,19 +10,33 @@ public:
 	Sky() {
 		mesh = AcquireMesh("quad.obj");
 		shader = AcquireShader("sky");
+		// Not part of any level, so never trimmed
+		PinResource(mesh);
 	}
 
 	void Draw(const Camera &cam) const {
-		glDepthMask(GL_FALSE);
+		GLState::DepthMask(GL_FALSE);
 		const Matrix4 mvp = cam.projection.Inverse();
 		const Matrix4 mv = cam.worldView.Inverse();
 		shader->Use();
 		shader->SetMVP(mvp.m, mv.m);
 		mesh->Draw();
-		glDepthMask(GL_TRUE);
+		GLState::DepthMask(GL_TRUE);
+	}
+
+	void DrawViews(const ViewSet &views) {
+		if (!mvShader) {
+			mvShader = AcquireShader("sky_mv");
+		}
+		GLState::DepthMask(GL_FALSE);
+		mvShader->Use();
+		views.Bind(*mvShader);
+		mesh->DrawInstanced(views.Count());
+		GLState::DepthMask(GL_TRUE);
 	}
 
 private:
-	std::shared_ptr<Mesh> mesh;
-	std::shared_ptr<Shader> shader;
+	Handle<Mesh> mesh;
+	Handle<Shader> shader;
+	Handle<Shader> mvShader;
 };
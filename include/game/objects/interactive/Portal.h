@@ -1,13 +1,18 @@
 #pragma once
 
 #include "core/engine/GameHeader.h"
+#include "core/util/Atom.h"
 #include "game/objects/base/Object.h"
-#include "rendering/FrameBuffer.h"
 #include "rendering/Mesh.h"
 #include "resources/Resources.h"
 #include "rendering/Shader.h"
 #include <memory>
 
+//Forward declarations
+class LayeredFrameBuffer;
+
+class ViewSet;
+
 class Portal : public Object {
 public:
 	//Subclass that represents a warp
@@ -17,16 +22,22 @@ public:
 			deltaInv.MakeIdentity();
 		}
 
+		// Rebuild delta and deltaInv from the current portal transforms
+		void Bake();
+
+		// Bake again if either portal moved since the last bake
+		void Refresh();
+
 		Matrix4 delta;
 		Matrix4 deltaInv;
 		const Portal *fromPortal;
 		const Portal *toPortal;
+		uint32_t fromVersion{0};
+		uint32_t toVersion{0};
 	};
 
-	std::string sourceTunnel;
+	Atom sourceTunnel; // level id of the tunnel
 	int doorNumber{};
-	std::string connectedTunnel;
-	int connectedDoor{};
 
 	Portal();
 
@@ -36,6 +47,15 @@ public:
 
 	void DrawPink(const Camera &cam) const;
 
+	// Draw into every view of a layered pass. srcLayers holds one entry per view:
+	// the layer of src to sample, -1 to hide the portal, -2 to draw it pink.
+	void DrawPortalViews(const ViewSet &views, const int *srcLayers, const LayeredFrameBuffer *src);
+
+	// Camera seen through this portal from cam, returns the portal to skip from there
+	const Portal *ViewCamera(const Camera &cam, Camera &portalCam) const;
+
+	[[nodiscard]] bool InFrustum(const Camera &cam) const;
+
 	[[nodiscard]] Vector3 GetBump(const Vector3 &a) const;
 
 	[[nodiscard]] const Warp *Intersects(const Vector3 &a, const Vector3 &b, const Vector3 &bump) const;
@@ -46,12 +66,17 @@ public:
 
 	static void Connect(Warp &a, Warp &b);
 
+	// Leave both warps pointing nowhere, the other portal is not touched
+	void Disconnect();
+
+	// Keep the warps in step with moving portals, call before they are used each frame
+	void RefreshWarps();
+
 	Warp front;
 	Warp back;
 
 private:
-	std::shared_ptr<Shader> errShader;
-	FrameBuffer frameBuf[GH_MAX_RECURSION - 1];
+	Handle<Shader> errShader;
 };
 
 typedef std::vector<std::shared_ptr<Portal> > PPortalVec;
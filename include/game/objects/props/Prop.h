@@ -0,0 +1,24 @@
+#pragma once
+
+#include "game/objects/base/Physical.h"
+
+// Dynamic box simulated like the player: gravity, bounce, friction and portals, which also
+// rescale it. One hit sphere fills the box. Props collide with the level, not with each other.
+class Prop : public Physical {
+public:
+	enum Type {
+		CRATE, // heavy friction, barely bounces
+		BALL,  // bouncy and slippery
+	};
+
+	explicit Prop(Type type = CRATE);
+
+	~Prop() override = default;
+
+	void Reset() override;
+
+	[[nodiscard]] Type GetType() const { return type; }
+
+private:
+	Type type;
+};
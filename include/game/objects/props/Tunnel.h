@@ -1,5 +1,6 @@
 #pragma once
 
+#include "game/LevelArena.h"
 #include "game/objects/base/Object.h"
 #include "game/objects/interactive/Portal.h"
 #include "resources/Resources.h"
@@ -28,49 +29,51 @@ public:
 	}
 
 	explicit Tunnel(Type type) : type(type) {
-		if (type == SCALE) {
-			mesh = AcquireMesh("tunnel_scale.obj");
-		} else if (type == SLOPE) {
-			mesh = AcquireMesh("tunnel_slope.obj");
-		} else {
-			mesh = AcquireMesh("tunnel.obj");
-		}
-		shader = AcquireShader("texture");
-		texture = AcquireTexture("tunnel.bmp");
+		// Interned once, a level builds many tunnels
+		static const Atom MESHES[] = {Atom("tunnel.obj"), Atom("tunnel_scale.obj"), Atom("tunnel_slope.obj")};
+		static const Atom SHADER("texture"), TEXTURE("tunnel.bmp");
+		mesh = AcquireMesh(MESHES[type]);
+		shader = AcquireShader(SHADER);
+		texture = AcquireTexture(TEXTURE);
 	}
 
 	explicit Tunnel(const std::string &typeStr) : Tunnel(TypeFromString(typeStr)) {}
 
 	~Tunnel() override = default;
 
+	// Doors are children of the tunnel and follow it when it moves. Their size only
+	// depends on the tunnel width, place them again after changing its scale.
 	void SetDoor1(Object &portal) const {
-		portal.pos = LocalToWorld().MulPoint(Vector3(0, 1, 1));
-		portal.euler = euler;
-		portal.scale = Vector3(0.6f, 0.999f, 1) * scale.x;
+		portal.pos = Vector3(0, 1, 1);
+		portal.euler.SetZero();
+		portal.scale = Vector3(0.6f, 0.999f, 1) * scale.x / scale;
 	}
 
 	void SetDoor2(Object &portal) const {
-		portal.euler = euler;
+		portal.euler.SetZero();
 		if (type == SCALE) {
-			portal.pos = LocalToWorld().MulPoint(Vector3(0, 0.5f, -1));
-			portal.scale = Vector3(0.3f, 0.499f, 0.5f) * scale.x;
+			portal.pos = Vector3(0, 0.5f, -1);
+			portal.scale = Vector3(0.3f, 0.499f, 0.5f) * scale.x / scale;
 		} else if (type == SLOPE) {
-			portal.pos = LocalToWorld().MulPoint(Vector3(0, -1, -1));
-			portal.scale = Vector3(0.6f, 0.999f, 1) * scale.x;
+			portal.pos = Vector3(0, -1, -1);
+			portal.scale = Vector3(0.6f, 0.999f, 1) * scale.x / scale;
 		} else {
-			portal.pos = LocalToWorld().MulPoint(Vector3(0, 1, -1));
-			portal.scale = Vector3(0.6f, 0.999f, 1) * scale.x;
+			portal.pos = Vector3(0, 1, -1);
+			portal.scale = Vector3(0.6f, 0.999f, 1) * scale.x / scale;
 		}
 	}
 
-	void CreatePortals(std::vector<std::shared_ptr<Portal>> &portals, const std::string &id) const {
-		auto portal1 = std::make_shared<Portal>();
+	// The portals live in the level arena
+	void CreatePortals(std::vector<std::shared_ptr<Portal>> &portals, Atom id, LevelArena &arena) {
+		auto portal1 = arena.Make<Portal>();
+		portal1->SetParent(this);
 		SetDoor1(*portal1);
 		portal1->sourceTunnel = id;
 		portal1->doorNumber = 1;
 		portals.push_back(portal1);
 
-		auto portal2 = std::make_shared<Portal>();
+		auto portal2 = arena.Make<Portal>();
+		portal2->SetParent(this);
 		SetDoor2(*portal2);
 		portal2->sourceTunnel = id;
 		portal2->doorNumber = 2;
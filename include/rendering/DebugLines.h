@@ -0,0 +1,47 @@
+#pragma once
+
+#include "core/camera/Camera.h"
+#include "core/math/Vector.h"
+#include "resources/ResourcePool.h"
+#include <GL/glew.h>
+#include <memory>
+#include <vector>
+
+class Shader;
+
+// Immediate-mode debug line batcher: lines are accumulated in world space
+// and drawn with a single call when the view is flushed.
+class DebugLines {
+public:
+	DebugLines();
+
+	~DebugLines();
+
+	void AddLine(const Vector3 &a, const Vector3 &b, const Vector3 &color);
+
+	// Outline of the unit square [-1, 1]^2 (z = 0) transformed by mat
+	void AddQuad(const Matrix4 &mat, const Vector3 &color);
+
+	// Draw everything accumulated so far from the given camera and clear the batch
+	void Flush(const Camera &cam);
+
+	[[nodiscard]] bool Empty() const { return vertices.empty(); }
+
+	DebugLines(const DebugLines &) = delete;
+
+	DebugLines &operator=(const DebugLines &) = delete;
+
+private:
+	struct Vertex {
+		float pos[3];
+		float color[3];
+	};
+
+	std::vector<Vertex> vertices;
+
+	GLuint vao{};
+	GLuint vbo{};
+	size_t capacity{}; // vertices the GPU buffer can hold
+
+	Handle<Shader> shader;
+};
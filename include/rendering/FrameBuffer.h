@@ -1,6 +1,7 @@
 #pragma once
 
 #include "core/camera/Camera.h"
+#include "rendering/MemoryStats.h"
 #include <GL/glew.h>
 
 // Forward declaration
@@ -25,6 +26,7 @@ private:
 	GLuint texId{};
 	GLuint fbo{};
 	GLuint renderBuf{};
+	MemoryCharge memory{MemoryStats::FRAMEBUFFER};
 
 	// Helper function to check if DSA is available
 	static bool HasDSASupport();
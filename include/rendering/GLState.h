@@ -0,0 +1,79 @@
+#pragma once
+
+#include <GL/glew.h>
+#include <cstdint>
+
+// Thin cache in front of the GL state setters used by the renderer.
+// Calls that would set the state it already has are skipped, and every
+// call is counted so redundant state changes show up per frame.
+class GLState {
+public:
+	enum Call {
+		PROGRAM,
+		TEXTURE,
+		VERTEX_ARRAY,
+		BUFFER,
+		FRAMEBUFFER,
+		VIEWPORT,
+		DEPTH_MASK,
+		DEPTH_FUNC,
+		COLOR_MASK,
+		NUM_CALLS
+	};
+
+	struct Stats {
+		uint32_t issued[NUM_CALLS];
+		uint32_t skipped[NUM_CALLS];
+
+		[[nodiscard]] uint32_t TotalIssued() const;
+
+		[[nodiscard]] uint32_t TotalSkipped() const;
+	};
+
+	static constexpr int MAX_TEXTURE_UNITS = 8;
+
+	static void UseProgram(GLuint program);
+
+	static void BindTexture(GLenum target, GLuint texture, unsigned int unit = 0);
+
+	static void BindVertexArray(GLuint vao);
+
+	static void BindBuffer(GLenum target, GLuint buffer);
+
+	static void BindFramebuffer(GLuint fbo);
+
+	static void Viewport(GLint x, GLint y, GLsizei width, GLsizei height);
+
+	static void DepthMask(GLboolean flag);
+
+	static void DepthFunc(GLenum func);
+
+	static void ColorMask(GLboolean r, GLboolean g, GLboolean b, GLboolean a);
+
+	// Deleted names can be recycled by GL, so they must be forgotten
+	static void OnDeleteProgram(GLuint program);
+
+	static void OnDeleteTexture(GLuint texture);
+
+	static void OnDeleteVertexArray(GLuint vao);
+
+	static void OnDeleteBuffer(GLuint buffer);
+
+	static void OnDeleteFramebuffer(GLuint fbo);
+
+	// Forget all cached state, for code that talks to GL directly
+	static void Invalidate();
+
+	// Close the current frame's counters and start new ones
+	static void BeginFrame();
+
+	static const Stats &LastFrame() { return lastFrame; }
+
+	static void PrintStats();
+
+private:
+	static bool Track(Call call, bool changed);
+
+	static Stats curFrame;
+	static Stats lastFrame;
+};
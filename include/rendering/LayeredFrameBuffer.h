@@ -0,0 +1,38 @@
+#pragma once
+
+#include "rendering/MemoryStats.h"
+#include <GL/glew.h>
+
+// Framebuffer backed by 2D texture arrays (color and depth), every layer
+// is a GH_FBO_SIZE view written in a single layered pass.
+class LayeredFrameBuffer {
+public:
+	LayeredFrameBuffer() = default;
+
+	~LayeredFrameBuffer();
+
+	// Make sure at least the given number of layers exists
+	void Reserve(int numLayers);
+
+	// Bind as render target, covering every layer
+	void Bind() const;
+
+	// Bind the color array for sampling
+	void Use(unsigned int slot = 0) const;
+
+	[[nodiscard]] int Layers() const { return layers; }
+
+	// Delete copy constructor and assignment operator
+	LayeredFrameBuffer(const LayeredFrameBuffer &) = delete;
+
+	LayeredFrameBuffer &operator=(const LayeredFrameBuffer &) = delete;
+
+private:
+	void Destroy();
+
+	GLuint texId{};
+	GLuint depthId{};
+	GLuint fbo{};
+	int layers{};
+	MemoryCharge memory{MemoryStats::FRAMEBUFFER};
+};
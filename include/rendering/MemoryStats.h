@@ -0,0 +1,59 @@
+#pragma once
+
+#include <cstddef>
+#include <string>
+
+// CPU and GPU bytes held by the rendering resources, per class. GPU sizes are computed from
+// the formats and sizes given to GL, drivers may pad them. Only the main thread updates them.
+class MemoryStats {
+public:
+	enum Class {
+		MESH,
+		TEXTURE,
+		FRAMEBUFFER,
+		SHADER,
+		NUM_CLASSES
+	};
+
+	struct Usage {
+		size_t cpu = 0;
+		size_t gpu = 0;
+		size_t count = 0; // live resources of the class
+	};
+
+	[[nodiscard]] static const Usage &Get(Class type) { return usage[type]; }
+
+	[[nodiscard]] static Usage Total();
+
+	// Totals per class and, if given, next to them the NUM_CLASSES usages of one level
+	static void Print(const std::string &title, const Usage *level = nullptr);
+
+private:
+	friend class MemoryCharge;
+
+	static Usage usage[NUM_CLASSES];
+};
+
+// The share of one resource in MemoryStats, withdrawn when the resource is destroyed
+class MemoryCharge {
+public:
+	explicit MemoryCharge(MemoryStats::Class type);
+
+	~MemoryCharge();
+
+	// Replace what the resource reported before
+	void Set(size_t cpu, size_t gpu);
+
+	[[nodiscard]] size_t Cpu() const { return cpu; }
+
+	[[nodiscard]] size_t Gpu() const { return gpu; }
+
+	MemoryCharge(const MemoryCharge &) = delete;
+
+	MemoryCharge &operator=(const MemoryCharge &) = delete;
+
+private:
+	MemoryStats::Class type;
+	size_t cpu = 0;
+	size_t gpu = 0;
+};
@@ -1,33 +1,82 @@
 #pragma once
 
 #include "core/math/Collider.h"
-#include "core/camera/Camera.h"
+#include "rendering/DebugLines.h"
+#include "rendering/MemoryStats.h"
+#include "resources/MappedFile.h"
+#include "resources/MeshBinary.h"
+#include "resources/MeshData.h"
 #include <GL/glew.h>
+#include <string>
 #include <vector>
-#include <map>
+
+// CPU side of a mesh load, filled without touching GL so it can run on a loader thread
+struct MeshSource {
+	// Mapping of a compiled mesh, the vertex arrays are uploaded straight from it
+	MappedFile file;
+	MeshBinary::View view{};
+	// Parsed OBJ, or only colliders and bounds for a compiled mesh
+	MeshData data;
+	bool compiled = false;
+};
 
 class Mesh {
 public:
 	static const int NUM_VBOS = 3;
 
+	// Load and upload synchronously
 	explicit Mesh(const char *fname);
 
+	// Empty mesh, loading until Finish makes it resident or Fail gives up on it
+	Mesh() : loading(true) {}
+
+	// File I/O and parsing only, thread safe
+	static bool Decode(const std::string &fname, MeshSource &src);
+
+	// GL upload, must run on the GL thread
+	void Finish(MeshSource &src);
+
+	// The file could not be read, the mesh stays empty
+	void Fail() { loading = false; }
+
+	[[nodiscard]] bool IsResident() const { return vao != 0; }
+
+	// Decoding or uploading on the loader, neither resident nor failed yet
+	[[nodiscard]] bool IsLoading() const { return loading; }
+
+	// Size of the vertex and index buffers
+	[[nodiscard]] size_t GpuBytes() const { return memory.Gpu(); }
+
+	[[nodiscard]] size_t CpuBytes() const { return memory.Cpu(); }
+
 	~Mesh();
 
 	void Draw() const;
 
-	void DebugDraw(const Camera &cam, const Matrix4 &objMat);
+	// One instance per view, for layered rendering
+	void DrawInstanced(GLsizei count) const;
+
+	void DebugDraw(DebugLines &lines, const Matrix4 &objMat) const;
 
 	std::vector<Collider> colliders;
 
+	// Local space bounding box of the vertices and colliders
+	Vector3 boundsMin{0.0f};
+	Vector3 boundsMax{0.0f};
+
 private:
-	void AddFace(
-			const std::vector<float> &vert_palette, const std::vector<float> &uv_palette,
-			uint32_t a, uint32_t at, uint32_t b, uint32_t bt, uint32_t c, uint32_t ct, bool is3DTex);
+	void Upload(const float *vertData, const float *uvData, const float *normalData, uint32_t numVerts, int uvSize,
+	            const uint32_t *indexData, uint32_t numIndices);
 
 	GLuint vao{};
 	GLuint vbo[NUM_VBOS]{};
+	GLuint ebo{};
+	uint32_t vertexCount{};
+	uint32_t indexCount{};
+	bool loading = false;
+	MemoryCharge memory{MemoryStats::MESH};
 
+	// Only kept for meshes parsed from OBJ with GH_KEEP_MESH_CPU_DATA, compiled meshes are uploaded from the mapping
 	std::vector<float> verts;
 	std::vector<float> uvs;
 	std::vector<float> normals;
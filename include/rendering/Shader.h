@@ -1,9 +1,18 @@
 #pragma once
 
+#include "core/math/Vector.h"
+#include "core/util/Hash.h"
+#include "rendering/MemoryStats.h"
 #include <GL/glew.h>
 #include <string>
+#include <string_view>
 #include <vector>
 
+// Hashed uniform name, resolved at compile time: shader->SetVec3(UniformId("color"), c)
+consteval uint32_t UniformId(std::string_view name) {
+	return HashFNV32(name);
+}
+
 class Shader {
 public:
 	explicit Shader(const char *name);
@@ -12,9 +21,7 @@ public:
 
 	void Use() const;
 
-	void SetMVP(const float *mvp, const float *mv) const;
-
-	bool CheckForUpdates();
+	void SetMVP(const float *mvp, const float *mv);
 
 	bool LoadShaders();
 
@@ -22,17 +29,62 @@ public:
 		return progId;
 	}
 
+	[[nodiscard]] const std::string &GetName() const { return name; }
+
+	[[nodiscard]] bool HasUniform(uint32_t id) const { return FindUniform(id) != nullptr; }
+
+	// Typed setters, the upload is skipped when the value did not change.
+	// The program must be bound with Use() before calling them.
+	void SetInt(uint32_t id, int value);
+
+	void SetFloat(uint32_t id, float value);
+
+	void SetVec3(uint32_t id, const Vector3 &value);
+
+	void SetVec4(uint32_t id, const Vector4 &value);
+
+	void SetMat4(uint32_t id, const float *value);
+
+	// Array uploads are not cached
+	void SetIntArray(uint32_t id, const int *values, int count);
+
+	void SetMat4Array(uint32_t id, const float *values, int count);
+
 private:
+	// Active uniform found by introspection after link
+	struct Uniform {
+		uint32_t id;       // hashed name, arrays are stored without the "[0]" suffix
+		GLint location;
+		GLenum type;
+		GLint size;        // array length
+		bool cached;       // value holds what was last uploaded
+		float value[16];
+	};
+
+	void ReflectUniforms();
+
+	[[nodiscard]] const Uniform *FindUniform(uint32_t id) const;
+
+	Uniform *FindUniform(uint32_t id) {
+		return const_cast<Uniform *>(static_cast<const Shader *>(this)->FindUniform(id));
+	}
 
-	static GLuint LoadGLSLShader(const char *fname, GLenum type);
+	// Returns the uniform if the new value differs from the cached one, updating the cache
+	Uniform *UpdateCache(uint32_t id, const void *value, size_t bytes);
 
-	static GLuint LoadSPIRVShader(const char *fname, GLenum type);
+	static bool ReadShaderFile(const char *fname, std::string &content);
+
+	static GLuint LoadGLSLShader(const std::string &content, const char *fname, GLenum type);
+
+	static GLuint LoadSPIRVShader(const std::string &content, const char *fname, GLenum type);
 
 	GLuint vertId;
 	GLuint fragId;
 	GLuint progId;
-	GLuint mvpId;
-	GLuint mvId;
+
+	std::vector<Uniform> uniforms; // sorted by id
+
+	MemoryCharge memory{MemoryStats::SHADER};
 
 	std::string name;
 };
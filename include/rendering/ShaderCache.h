@@ -0,0 +1,31 @@
+#pragma once
+
+#include <GL/glew.h>
+#include <cstdint>
+#include <string>
+
+// On-disk cache of linked program binaries (GL_ARB_get_program_binary).
+// Entries are keyed by a hash of the shader sources and of the driver strings,
+// so editing a shader or updating the driver invalidates them automatically.
+class ShaderCache {
+public:
+	static bool IsSupported();
+
+	// Hash of the sources combined with the vendor/renderer/version strings
+	static uint64_t MakeKey(const std::string &vertSource, const std::string &fragSource);
+
+	// Try to load a cached binary into the given program, returns false on miss
+	static bool Load(GLuint progId, const std::string &name, uint64_t key);
+
+	// Store the binary of a successfully linked program
+	static void Store(GLuint progId, const std::string &name, uint64_t key);
+
+	static int Hits() { return hits; }
+	static int Misses() { return misses; }
+
+private:
+	static std::string PathFor(const std::string &name);
+
+	static int hits;
+	static int misses;
+};
@@ -1,7 +1,13 @@
 #pragma once
 
+#include "rendering/MemoryStats.h"
+#include "resources/DdsImage.h"
 #include <GL/glew.h>
+#include <cstddef>
+#include <cstdlib>
+#include <memory>
 #include <string>
+#include <vector>
 
 enum class TextureType {
 	DIFFUSE,
@@ -13,25 +19,79 @@ enum class TextureType {
 	HDR
 };
 
+// CPU side of a texture load, decoded without touching GL so it can run on a loader thread
+struct TextureSource {
+	std::unique_ptr<void, void (*)(void *)> pixels{nullptr, std::free};
+	size_t size = 0;
+	GLenum target = GL_TEXTURE_2D;
+	GLint internalFormat = GL_RGB8;
+	GLenum format = GL_RGB;
+	GLenum dataType = GL_UNSIGNED_BYTE;
+	int width = 0;
+	int height = 0;
+	int layers = 1;
+	GLint minFilter = GL_LINEAR;
+	GLint magFilter = GL_LINEAR;
+	GLint wrap = GL_REPEAT;
+	bool mipmaps = false;
+	// Precomputed block compressed mip chain, offsets are relative to pixels
+	std::vector<DdsImage::Mip> levels;
+	bool isHDR = false;
+	TextureType type = TextureType::DIFFUSE;
+};
+
 class Texture {
 public:
+	// Load and upload synchronously
 	Texture(const char *fname, int rows = 1, int cols = 1, TextureType type = TextureType::DIFFUSE);
+
+	// Empty texture, made resident later by Finish
+	Texture() = default;
+
 	~Texture();
 
+	// File I/O and decoding only, thread safe
+	static bool Decode(const std::string &fname, int rows, int cols, TextureType type, TextureSource &src);
+
+	// One array layer per file, in order. Layers of different sizes are resampled to the largest one
+	static bool DecodeArray(const std::vector<std::string> &fnames, TextureSource &src);
+
+	// GL upload, pixels is either src.pixels or an offset into the bound unpack buffer
+	void Finish(const TextureSource &src, const void *pixels);
+
 	void Use(unsigned int slot = 0) const;
 
+	bool IsResident() const { return texId != 0; }
+
+	// Estimated from the uploaded levels, generated mipmaps included
+	[[nodiscard]] size_t GpuBytes() const { return memory.Gpu(); }
+
+	[[nodiscard]] size_t CpuBytes() const { return memory.Cpu(); }
+
+	// Where the texture comes from, set by the constructor or by AcquireTexture for async loads
+	void SetSource(const std::string &fname, int rows, int cols, TextureType textureType);
+
+	[[nodiscard]] const std::string &GetName() const { return name; }
+
+	// A single diffuse BMP, can be packed with others into a level texture array
+	[[nodiscard]] bool IsPackable() const;
+
 	bool IsHDR() const { return isHDR; }
 	bool Is3D() const { return is3D; }
 	TextureType GetType() const { return type; }
 	GLuint GetID() const { return texId; }
 
 private:
-	bool LoadBMP(const std::string& path, int rows, int cols);
-	bool LoadHDR(const std::string& path);
-	bool LoadSTB(const std::string& path);
+	static bool DecodeBMP(const std::string &path, int rows, int cols, TextureSource &src);
+	static bool DecodeDDS(const std::string &path, int rows, int cols, TextureSource &src);
+	static bool DecodeHDR(const std::string &path, TextureSource &src);
+	static bool DecodeSTB(const std::string &path, TextureType type, TextureSource &src);
 
+	std::string name;
+	int tiles{1};
 	GLuint texId{0};
+	MemoryCharge memory{MemoryStats::TEXTURE};
 	bool is3D{false};
 	bool isHDR{false};
-	TextureType type;
-};
\ No newline at end of file
+	TextureType type{TextureType::DIFFUSE};
+};
@@ -0,0 +1,41 @@
+#pragma once
+
+#include "core/camera/Camera.h"
+#include "core/engine/GameHeader.h"
+#include <vector>
+
+// Forward declarations
+class Portal;
+
+class Shader;
+
+// All the views rendered together in one layered pass. View i is written
+// to layer i of the bound framebuffer, shaders select it with gl_InstanceID.
+class ViewSet {
+public:
+	void Clear();
+
+	// Returns the index of the new view, or -1 if the set is full
+	int Add(const Camera &cam, const Portal *skipPortal);
+
+	// Upload the per-view matrices, only once per shader for this set
+	void Bind(Shader &shader) const;
+
+	[[nodiscard]] int Count() const { return count; }
+
+	[[nodiscard]] const Camera &GetCamera(int i) const { return cams[i]; }
+
+	[[nodiscard]] const Portal *SkipPortal(int i) const { return skip[i]; }
+
+private:
+	int count = 0;
+	Camera cams[GH_MULTIVIEW_MAX_VIEWS];
+	const Portal *skip[GH_MULTIVIEW_MAX_VIEWS]{};
+
+	// Row-major matrices packed for a single glUniformMatrix4fv each
+	float viewProj[GH_MULTIVIEW_MAX_VIEWS * 16]{};
+	float invProj[GH_MULTIVIEW_MAX_VIEWS * 16]{};
+	float invView[GH_MULTIVIEW_MAX_VIEWS * 16]{};
+
+	mutable std::vector<const Shader *> boundShaders;
+};
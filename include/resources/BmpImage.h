@@ -0,0 +1,22 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <memory>
+#include <string>
+
+// Uncompressed 24-bit BMP, kept in its BGR byte order (swizzled by GL on upload).
+// An atlas of rows x cols tiles is rearranged so that every tile is contiguous,
+// ready to be uploaded as the layers of a texture array.
+struct BmpImage {
+	std::unique_ptr<void, void (*)(void *)> pixels{nullptr, std::free};
+	size_t size = 0;
+	// Size of a single tile
+	int width = 0;
+	int height = 0;
+	int layers = 1;
+};
+
+// One mapping of the file, rows are copied in bulk
+bool LoadBMP(const std::string &path, int rows, int cols, BmpImage &image);
@@ -0,0 +1,51 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <memory>
+#include <string>
+#include <vector>
+
+// Block compressed formats stored in DDS files
+enum class BlockFormat {
+	BC1, // RGB, 8 bytes per 4x4 block
+	BC3, // RGBA, 16 bytes per block
+	BC7  // RGBA, 16 bytes per block, best quality
+};
+
+// DDS texture with its full mip chain, optionally an array of layers.
+// Data is stored mip-major: every layer of mip 0, then every layer of mip 1...
+struct DdsImage {
+	struct Mip {
+		size_t offset;
+		size_t size;   // all the layers of this level
+		int width;
+		int height;
+	};
+
+	BlockFormat format = BlockFormat::BC1;
+	int width = 0;
+	int height = 0;
+	int layers = 1;
+	std::vector<Mip> mips;
+	std::unique_ptr<void, void (*)(void *)> data{nullptr, std::free};
+	size_t size = 0;
+
+	static size_t BlockBytes(BlockFormat format) { return format == BlockFormat::BC1 ? 8 : 16; }
+
+	// Bytes of one layer of a mip level
+	static size_t LevelSize(BlockFormat format, int width, int height);
+};
+
+// Compressed sibling of a source image, e.g. floor.bmp -> floor.dds
+std::string DdsPathFor(const std::string &path);
+
+// True if dds exists and is not older than its source image
+bool DdsIsUpToDate(const std::string &path, const std::string &dds);
+
+bool LoadDDS(const std::string &path, DdsImage &image);
+
+// Layer-major blocks in, as produced by an encoder: layer 0 mips 0..n, layer 1...
+bool WriteDDS(const std::string &path, BlockFormat format, int width, int height, int layers, int mipCount,
+              const std::vector<uint8_t> &blocks);
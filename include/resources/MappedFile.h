@@ -0,0 +1,37 @@
+#pragma once
+
+#include <cstddef>
+#include <string>
+
+// Read-only memory mapping of a whole file, unmapped on destruction
+class MappedFile {
+public:
+	MappedFile() = default;
+
+	explicit MappedFile(const std::string &path) { Open(path); }
+
+	~MappedFile();
+
+	bool Open(const std::string &path);
+
+	void Close();
+
+	[[nodiscard]] bool IsOpen() const { return data != nullptr; }
+
+	[[nodiscard]] const char *Data() const { return static_cast<const char *>(data); }
+
+	[[nodiscard]] size_t Size() const { return size; }
+
+	// Delete copy constructor and assignment operator
+	MappedFile(const MappedFile &) = delete;
+
+	MappedFile &operator=(const MappedFile &) = delete;
+
+private:
+	void *data = nullptr;
+	size_t size = 0;
+#if defined(_WIN32)
+	void *fileHandle = nullptr;
+	void *mapHandle = nullptr;
+#endif
+};
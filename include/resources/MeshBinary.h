@@ -0,0 +1,47 @@
+#pragma once
+
+#include "resources/MeshData.h"
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+// Compiled mesh format written by the mesh_compiler tool. The file is a header
+// followed by tightly packed arrays, so it can be uploaded straight from a mapping:
+// positions, uvs, normals, indices, collider matrices (row-major, 16 floats each).
+class MeshBinary {
+public:
+	static constexpr uint32_t MAGIC = 0x424D454E; // "NEMB"
+	static constexpr uint32_t VERSION = 1;
+
+	struct Header {
+		uint32_t magic;
+		uint32_t version;
+		uint32_t vertexCount;
+		uint32_t indexCount;
+		uint32_t uvSize;
+		uint32_t colliderCount;
+		float boundsMin[3];
+		float boundsMax[3];
+	};
+
+	// Pointers into a validated file image
+	struct View {
+		const Header *header;
+		const float *verts;
+		const float *uvs;
+		const float *normals;
+		const uint32_t *indices;
+		const float *colliders;
+	};
+
+	// Compiled file that sits next to an OBJ
+	static std::string PathFor(const std::string &objPath);
+
+	// True if the compiled file exists and is not older than its source
+	static bool IsUpToDate(const std::string &objPath, const std::string &binPath);
+
+	static bool Write(const MeshData &data, const std::string &path);
+
+	// Check the header and sizes of a file image, fill the view on success
+	static bool Parse(const void *bytes, size_t size, View &view);
+};
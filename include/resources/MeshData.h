@@ -0,0 +1,33 @@
+#pragma once
+
+#include "core/math/Collider.h"
+#include "core/math/Vector.h"
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// CPU side mesh, independent of GL so it can be built offline or off the render thread
+struct MeshData {
+	std::vector<float> verts;
+	std::vector<float> uvs;
+	std::vector<float> normals;
+	// Empty when every vertex is drawn in order
+	std::vector<uint32_t> indices;
+	std::vector<Collider> colliders;
+
+	// Components per texture coordinate, 3 for texture arrays
+	int uvSize = 2;
+
+	Vector3 boundsMin{0.0f};
+	Vector3 boundsMax{0.0f};
+
+	[[nodiscard]] uint32_t VertexCount() const { return static_cast<uint32_t>(verts.size() / 3); }
+
+	void ComputeBounds();
+
+	// Merge identical vertices and build the index list
+	void Weld();
+};
+
+// Parse an OBJ file, including the wildcard (*) faces and the collider (c) lines
+bool LoadObj(const std::string &path, MeshData &data);
@@ -0,0 +1,62 @@
+#pragma once
+
+#include "rendering/Mesh.h"
+#include "rendering/Texture.h"
+#include "core/util/ThreadPool.h"
+#include "resources/ResourcePool.h"
+#include <GL/glew.h>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+// Background loading of meshes and textures. File I/O and decoding run on a
+// thread pool, the GL uploads are queued and drained on the GL thread within
+// a time budget per frame. Until then the resource exists but is not resident.
+// Jobs only hold handles, a resource released while loading is skipped.
+class ResourceLoader {
+public:
+	static void Start(unsigned int numThreads);
+
+	// Drops queued work and releases the upload buffer, needs the GL context
+	static void Stop();
+
+	[[nodiscard]] static bool IsRunning() { return pool != nullptr; }
+
+	static void LoadMesh(Handle<Mesh> mesh, const std::string &fname);
+
+	static void LoadTexture(Handle<Texture> texture, const std::string &fname, int rows, int cols, TextureType type);
+
+	static void LoadTextureArray(Handle<Texture> texture, const std::vector<std::string> &fnames);
+
+	// Upload decoded resources until budgetMs is spent, at least one per call
+	static void Update(float budgetMs);
+
+	// Block until every queued resource is resident
+	static void Finish();
+
+	[[nodiscard]] static int Pending();
+
+private:
+	// Decoded resource waiting for its GL upload
+	struct Upload {
+		std::function<void()> finish;
+		bool isMesh;
+	};
+
+	static void Push(Upload upload);
+
+	static void SubmitTexture(Handle<Texture> texture, std::function<bool(TextureSource &)> decode);
+
+	static void UploadTexture(Texture &texture, const TextureSource &src);
+
+	static std::unique_ptr<ThreadPool> pool;
+	static std::mutex mutex;
+	static std::deque<Upload> ready;
+	static int pendingMeshes;
+	static int pendingTextures;
+	static GLuint pbo;
+	static size_t pboSize;
+};
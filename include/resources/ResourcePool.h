@@ -0,0 +1,241 @@
+#pragma once
+
+#include "core/util/Atom.h"
+#include <algorithm>
+#include <cstdint>
+#include <deque>
+#include <optional>
+#include <string_view>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+template<typename T>
+class ResourcePool;
+
+// 32-bit reference to a pooled resource: slot index in the low bits, slot generation in
+// the high bits. A handle to a released resource resolves to nullptr, never to its successor.
+template<typename T>
+class Handle {
+public:
+	static constexpr uint32_t INDEX_BITS = 20;
+	static constexpr uint32_t INDEX_MASK = (1u << INDEX_BITS) - 1;
+	static constexpr uint32_t MAX_GENERATION = (1u << (32 - INDEX_BITS)) - 1;
+
+	Handle() = default;
+
+	Handle(uint32_t index, uint32_t generation) : value((generation << INDEX_BITS) | index) {}
+
+	[[nodiscard]] uint32_t Index() const { return value & INDEX_MASK; }
+	[[nodiscard]] uint32_t Generation() const { return value >> INDEX_BITS; }
+	[[nodiscard]] uint32_t Value() const { return value; }
+
+	// O(1): bounds and generation check, no refcounting
+	[[nodiscard]] T *Get() const { return ResourcePool<T>::Instance().Get(*this); }
+
+	T *operator->() const { return Get(); }
+	T &operator*() const { return *Get(); }
+
+	explicit operator bool() const { return Get() != nullptr; }
+
+	bool operator==(const Handle &other) const = default;
+
+private:
+	uint32_t value = 0; // generations start at 1, so 0 is never valid
+};
+
+// Dense, generational storage for one resource type, keyed by interned name and variant.
+// Slots live in a deque so resources never move, and released slots are recycled.
+// Lifetime is explicit: a resource stays alive until Release, Evict or Clear, whoever holds handles.
+// Not thread safe, only the main thread touches the pools.
+template<typename T>
+class ResourcePool {
+public:
+	static ResourcePool &Instance() {
+		static ResourcePool pool;
+		return pool;
+	}
+
+	// Integer lookup, variant tells apart resources sharing a file name
+	[[nodiscard]] Handle<T> Find(Atom name, uint32_t variant = 0) const {
+		const auto it = names.find(Key{name, variant});
+		return it == names.end() ? Handle<T>() : Handle<T>(it->second, slots[it->second].generation);
+	}
+
+	// A name never interned was never inserted either
+	[[nodiscard]] Handle<T> Find(std::string_view name, uint32_t variant = 0) const {
+		const Atom atom = Atom::Find(name);
+		return atom.Empty() && !name.empty() ? Handle<T>() : Find(atom, variant);
+	}
+
+	// Construct a new resource in place
+	template<typename... Args>
+	Handle<T> Emplace(Atom name, uint32_t variant, Args &&... args) {
+		uint32_t index;
+		if (!freeList.empty()) {
+			index = freeList.back();
+			freeList.pop_back();
+		} else {
+			index = static_cast<uint32_t>(slots.size());
+			slots.emplace_back();
+		}
+		Slot &slot = slots[index];
+		try {
+			slot.resource.emplace(std::forward<Args>(args)...);
+		} catch (...) {
+			freeList.push_back(index);
+			throw;
+		}
+		slot.name = name;
+		slot.variant = variant;
+		slot.lastUse = clock;
+		names.emplace(Key{name, variant}, index);
+		return {index, slot.generation};
+	}
+
+	[[nodiscard]] T *Get(Handle<T> handle) const {
+		const uint32_t index = handle.Index();
+		if (index >= slots.size() || slots[index].generation != handle.Generation()) {
+			return nullptr;
+		}
+		const Slot &slot = slots[index];
+		return slot.resource ? const_cast<T *>(&*slot.resource) : nullptr;
+	}
+
+	// Rebuild the resource in place, existing handles keep pointing at it
+	template<typename... Args>
+	bool Replace(Handle<T> handle, Args &&... args) {
+		if (!Get(handle)) {
+			return false;
+		}
+		Slot &slot = slots[handle.Index()];
+		slot.resource.reset();
+		slot.resource.emplace(std::forward<Args>(args)...);
+		return true;
+	}
+
+	// Destroy the resource now, every handle to it becomes invalid
+	bool Release(Handle<T> handle) {
+		if (!Get(handle)) {
+			return false;
+		}
+		const uint32_t index = handle.Index();
+		Slot &slot = slots[index];
+		names.erase(Key{slot.name, slot.variant});
+		slot.resource.reset();
+		slot.name = Atom();
+		slot.pins = 0;
+		// A slot whose generation would wrap is retired instead of recycled
+		if (slot.generation < Handle<T>::MAX_GENERATION) {
+			slot.generation += 1;
+			freeList.push_back(index);
+		}
+		return true;
+	}
+
+	// Mark the resource as used now, for Evict
+	void Touch(Handle<T> handle) {
+		if (Get(handle)) {
+			slots[handle.Index()].lastUse = clock;
+		}
+	}
+
+	// Pinned resources are never evicted, pins nest
+	void Pin(Handle<T> handle) {
+		if (Get(handle)) {
+			slots[handle.Index()].pins += 1;
+		}
+	}
+
+	void Unpin(Handle<T> handle) {
+		if (Get(handle) && slots[handle.Index()].pins > 0) {
+			slots[handle.Index()].pins -= 1;
+		}
+	}
+
+	// Start a new use period, Evict spares what was touched in it
+	void Tick() { clock += 1; }
+
+	// Release the least recently used resources, unpinned and not touched since the last Tick,
+	// until the bytes(resource) of the rest fit in budget. Returns the bytes released.
+	template<typename F>
+	size_t Evict(size_t budget, F &&bytes, size_t *evicted = nullptr) {
+		size_t total = 0;
+		std::vector<std::pair<uint64_t, uint32_t>> candidates;
+		for (uint32_t i = 0; i < slots.size(); ++i) {
+			const Slot &slot = slots[i];
+			if (!slot.resource) {
+				continue;
+			}
+			total += bytes(*slot.resource);
+			if (slot.pins == 0 && slot.lastUse < clock) {
+				candidates.emplace_back(slot.lastUse, i);
+			}
+		}
+		std::sort(candidates.begin(), candidates.end());
+		size_t released = 0;
+		for (const auto &[lastUse, index]: candidates) {
+			if (total <= budget) {
+				break;
+			}
+			const size_t size = bytes(*slots[index].resource);
+			Release(Handle<T>(index, slots[index].generation));
+			total -= size;
+			released += size;
+			if (evicted) {
+				*evicted += 1;
+			}
+		}
+		return released;
+	}
+
+	void Clear() {
+		for (uint32_t i = 0; i < slots.size(); ++i) {
+			Release(Handle<T>(i, slots[i].generation));
+		}
+	}
+
+	// f(name, resource) for every live resource
+	template<typename F>
+	void ForEach(F &&f) {
+		for (Slot &slot: slots) {
+			if (slot.resource) {
+				f(slot.name.View(), *slot.resource);
+			}
+		}
+	}
+
+	[[nodiscard]] size_t Size() const { return names.size(); }
+
+private:
+	struct Slot {
+		std::optional<T> resource;
+		Atom name;
+		uint32_t variant = 0;
+		uint32_t generation = 1;
+		uint32_t pins = 0;
+		uint64_t lastUse = 0;
+	};
+
+	struct Key {
+		Atom name;
+		uint32_t variant;
+
+		bool operator==(const Key &other) const = default;
+	};
+
+	// The atom and the variant packed in 64 bits, then mixed so both halves reach the buckets
+	struct KeyHash {
+		size_t operator()(const Key &key) const {
+			const uint64_t packed = static_cast<uint64_t>(key.name.Id()) << 32 | key.variant;
+			return static_cast<size_t>(packed * 0x9E3779B97F4A7C15ull >> 16);
+		}
+	};
+
+	ResourcePool() = default;
+
+	std::deque<Slot> slots;
+	uint64_t clock = 1;
+	std::vector<uint32_t> freeList;
+	std::unordered_map<Key, uint32_t, KeyHash> names;
+};
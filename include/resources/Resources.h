@@ -3,14 +3,61 @@
 #include "rendering/Mesh.h"
 #include "rendering/Texture.h"
 #include "rendering/Shader.h"
-#include <memory>
+#include "resources/ResourcePool.h"
+#include <string>
+#include <vector>
 
-std::shared_ptr<Mesh> AcquireMesh(const char *name);
+// Resources are pooled and referenced by generational handles. Acquiring a name that is
+// already loaded is a hash lookup without allocations. Resources outlive the objects that
+// used them, so a level loaded again finds them in the pools: meshes and textures are only
+// released by TrimResources, least recently used first, or by ReleaseResources.
+// Handles held past that point resolve to nullptr.
+// Names are interned: callers that acquire the same name often keep it as a static Atom,
+// then a lookup hashes two integers instead of the string.
 
-std::shared_ptr<Shader> AcquireShader(const char *name);
+Handle<Mesh> AcquireMesh(Atom name);
+Handle<Mesh> AcquireMesh(const char *name);
 
-std::shared_ptr<Texture> AcquireTexture(const char *name, int rows = 1, int cols = 1, TextureType type = TextureType::DIFFUSE);
+Handle<Shader> AcquireShader(Atom name);
+Handle<Shader> AcquireShader(const char *name);
 
+Handle<Texture> AcquireTexture(Atom name, int rows = 1, int cols = 1, TextureType type = TextureType::DIFFUSE);
+Handle<Texture> AcquireTexture(const char *name, int rows = 1, int cols = 1, TextureType type = TextureType::DIFFUSE);
+
+// Every texture as one layer of a GL_TEXTURE_2D_ARRAY, cached by the list of names
+Handle<Texture> AcquireTextureArray(const std::vector<std::string> &names);
+
+// Destroy every pooled resource, needs the GL context
+void ReleaseResources();
+
+// Pinned meshes and textures are never trimmed, for those used outside of levels
+void PinResource(Handle<Mesh> mesh);
+void PinResource(Handle<Texture> texture);
+void UnpinResource(Handle<Mesh> mesh);
+void UnpinResource(Handle<Texture> texture);
+
+// Start a use period: TrimResources spares what is acquired or touched after this call
+void BeginResourceUse();
+void TouchResource(Handle<Mesh> mesh);
+void TouchResource(Handle<Texture> texture);
+
+// Release the meshes and textures not used in the current period, least recently used first,
+// until the rest takes at most budgetBytes of GPU memory
+void TrimResources(size_t budgetBytes);
+
+// Counters since startup, callers take differences around a load
+struct ResourceStats {
+	size_t hits = 0;         // Acquire found the resource loaded
+	size_t misses = 0;       // Acquire had to load it
+	size_t evicted = 0;
+	size_t evictedBytes = 0;
+	size_t residentBytes = 0; // meshes and textures after the last trim
+};
+
+const ResourceStats &GetResourceStats();
+
+// Reload the shaders whose files changed, as reported by a background watcher. Cheap
+// enough to call every frame. forceReload recompiles every shader right away.
 void CheckForShaderUpdates(bool forceReload = false);
 
 bool ReloadShader(const char *name);
@@ -3,6 +3,24 @@
 #endif
 
 #include "core/engine/Engine.h"
+#include <algorithm>
+#include <filesystem>
+#include <string>
+#include <vector>
+
+// --bench <directory>: time every level of the directory instead of playing
+static bool BenchmarkLevels(int argc, char **argv, std::vector<std::string> &levels) {
+	if (argc < 3 || std::string(argv[1]) != "--bench") {
+		return false;
+	}
+	for (const auto &entry: std::filesystem::directory_iterator(argv[2])) {
+		if (entry.path().extension() == ".yaml") {
+			levels.push_back(entry.path().string());
+		}
+	}
+	std::sort(levels.begin(), levels.end());
+	return true;
+}
 
 #if defined(_WIN32)
 
@@ -18,7 +36,12 @@ int APIENTRY WinMain(HINSTANCE hCurrentInst, HINSTANCE hPreviousInst, LPSTR lpsz
 #endif
 
   //Run the main engine
-  Engine engine;
+  std::vector<std::string> levels;
+  const bool benchmark = BenchmarkLevels(__argc, __argv, levels);
+  Engine engine(benchmark);
+  if (benchmark) {
+	return engine.RunBenchmark(levels);
+  }
   return engine.Run();
 }
 
@@ -27,7 +50,12 @@ int APIENTRY WinMain(HINSTANCE hCurrentInst, HINSTANCE hPreviousInst, LPSTR lpsz
 // --- non-Windows ----------------------------------------------------------
 
 int main(int argc, char **argv) {
-	Engine engine;
+	std::vector<std::string> levels;
+	const bool benchmark = BenchmarkLevels(argc, argv, levels);
+	Engine engine(benchmark);
+	if (benchmark) {
+		return engine.RunBenchmark(levels);
+	}
 	return engine.Run();
 }
 
@@ -1,5 +1,6 @@
 #include "core/camera/Camera.h"
 #include "core/engine/GameHeader.h"
+#include "rendering/GLState.h"
 #include <GL/glew.h>
 #include <cmath>
 
@@ -62,7 +63,7 @@ Matrix4 Camera::Matrix() const {
 }
 
 void Camera::UseViewport() const {
-	glViewport(0, 0, width, height);
+	GLState::Viewport(0, 0, width, height);
 }
 
 void Camera::ClipOblique(const Vector3 &pos, const Vector3 &normal) {
@@ -1,7 +1,15 @@
 #include "core/engine/Engine.h"
 #include "game/objects/base/Physical.h"
 #include "game/DefaultScene.h"
+#include "game/objects/props/Prop.h"
 #include "core/input/InputAdapter.h"
+#include "rendering/DebugLines.h"
+#include "rendering/GLState.h"
+#include "rendering/LayeredFrameBuffer.h"
+#include "rendering/MemoryStats.h"
+#include "rendering/ShaderCache.h"
+#include "resources/ResourceLoader.h"
+#include "resources/Resources.h"
 
 #if defined(_WIN32)
 #include <GL/wglew.h>
@@ -13,6 +21,8 @@
 #endif
 
 #include <cmath>
+#include <cstdio>
+#include <filesystem>
 #include <iostream>
 #include <algorithm>
 #include <memory>
@@ -23,7 +33,10 @@ const Input *GH_INPUT = nullptr;
 int GH_REC_LEVEL = 0;
 int64_t GH_FRAME = 0;
 
-Engine::Engine() {
+Engine::Engine(bool benchmark) : benchmark(benchmark) {
+	Timer startupTimer;
+	startupTimer.Start();
+
 	GH_ENGINE = this;
 	GH_INPUT = &input;
 	isFullscreen = false;
@@ -45,6 +58,10 @@ Engine::Engine() {
 	InitGLObjects();
 	SetupInputs();
 
+	if (GH_ASYNC_LOADING) {
+		ResourceLoader::Start(GH_LOADER_THREADS);
+	}
+
 	player = std::make_shared<Player>();
 	GH_PLAYER = player.get();
 
@@ -57,7 +74,19 @@ Engine::Engine() {
 	curScene = std::make_shared<DefaultScene>();
 	LoadScene("l1-doubleTunnel");
 
+	// The other levels are parsed and built in the background
+	if (GH_PRELOAD_LEVELS && !benchmark) {
+		for (const std::string &name: levelManager.RegisteredLevels()) {
+			if (name != curLevelName) {
+				levelManager.Preload(name);
+			}
+		}
+	}
+
 	sky = std::make_shared<Sky>();
+
+	std::cout << "Avvio completato in " << startupTimer.Stop() * 1000.0f << " ms (shader cache: "
+	          << ShaderCache::Hits() << " hit, " << ShaderCache::Misses() << " miss)\n";
 }
 
 Engine::~Engine() {
@@ -70,6 +99,62 @@ int Engine::Run() {
 	return 0;
 }
 
+int Engine::RunBenchmark(const std::vector<std::string> &levelPaths) {
+	struct Result {
+		std::string name;
+		size_t objects;
+		size_t portals;
+		size_t bodies;
+		size_t allocations;
+		float loadMs;
+		float tickMs;
+		float frameMs;
+	};
+	std::vector<Result> results;
+	Timer benchTimer;
+	for (const std::string &path: levelPaths) {
+		const std::string name = std::filesystem::path(path).stem().string();
+		levelManager.RegisterLevel(name, path);
+
+		// Load, including the background uploads of meshes and textures
+		benchTimer.Start();
+		LoadScene(name);
+		if (curLevelName != name) {
+			continue;
+		}
+		while (ResourceLoader::Pending() > 0) {
+			ResourceLoader::Update(GH_LOADER_BUDGET_MS);
+		}
+		const float loadMs = benchTimer.Stop() * 1000.0f;
+
+		benchTimer.Start();
+		for (int i = 0; i < GH_BENCH_TICKS; ++i) {
+			Update();
+			GH_FRAME += 1;
+		}
+		const float tickMs = benchTimer.Stop() * 1000.0f / GH_BENCH_TICKS;
+
+		benchTimer.Start();
+		for (int i = 0; i < GH_BENCH_FRAMES; ++i) {
+			RenderFrame();
+			glFinish();
+		}
+		const float frameMs = benchTimer.Stop() * 1000.0f / GH_BENCH_FRAMES;
+
+		results.push_back({name, vObjects.size(), vPortals.size(), store.Bodies().size(),
+		                   curLevel->arena.Allocations(), loadMs, tickMs, frameMs});
+	}
+
+	std::printf("%-24s %8s %8s %8s %10s %10s %10s %10s\n", "livello", "oggetti", "portali", "corpi", "allocaz.",
+	            "load ms", "tick ms", "frame ms");
+	for (const Result &r: results) {
+		std::printf("%-24s %8zu %8zu %8zu %10zu %10.2f %10.4f %10.3f\n", r.name.c_str(), r.objects, r.portals,
+		            r.bodies, r.allocations, r.loadMs, r.tickMs, r.frameMs);
+	}
+	DestroyGLObjects();
+	return results.size() == levelPaths.size() ? 0 : 1;
+}
+
 void Engine::PeriodicRender(int64_t &cur_ticks) {
 	//Used fixed time steps for updates
 	const int64_t new_ticks = timer.GetTicks();
@@ -81,13 +166,30 @@ void Engine::PeriodicRender(int64_t &cur_ticks) {
 	}
 	cur_ticks = (cur_ticks < new_ticks ? new_ticks : cur_ticks);
 
+	//Start counting GL state changes for this frame
+	GLState::BeginFrame();
+
+	//Upload what the loader threads decoded, within the frame budget
+	ResourceLoader::Update(GH_LOADER_BUDGET_MS);
+	levelManager.Update(*curScene);
+	ReloadLevelIfChanged();
+	CheckForShaderUpdates();
+
+	RenderFrame();
+}
+
+void Engine::RenderFrame() {
 	//Setup camera for rendering
 	const float n = GH_CLAMP(NearestPortalDist() * 0.5f, GH_NEAR_MIN, GH_NEAR_MAX);
 	main_cam.worldView = player->WorldToCam();
 	main_cam.SetSize(iWidth, iHeight, n, GH_FAR);
 	main_cam.UseViewport();
+	frameReach = portalGraph.ReachableFrom(main_cam, GH_MAX_RECURSION);
 
 	//Render scene
+	if (useMultiview && RenderMultiview(main_cam)) {
+		return;
+	}
 	GH_REC_LEVEL = GH_MAX_RECURSION;
 	Render(main_cam, 0, nullptr);
 }
@@ -97,87 +199,155 @@ void Engine::LoadScene(const std::string &levelName) {
 		std::cerr << "ERRORE: Scena non inizializzata\n";
 		return;
 	}
-	try {
-		auto config = levelManager.LoadConfig(levelName);
-		std::cout << "Caricamento livello: " << config.name << "\n";
-		std::cout << "Oggetti da caricare: " << config.objects.size() << "\n";
+	Timer switchTimer;
+	switchTimer.Start();
+
+	// Benchmarks time every level alone, the previous one is gone before the next is built
+	if (benchmark && curLevel) {
+		DropLevel();
+	}
 
-		if (config.objects.empty()) {
-			std::cerr << "Attenzione: livello senza oggetti!\n";
+	// A preloaded level is already built, otherwise build it now
+	std::shared_ptr<Level> level;
+	bool preloaded = false;
+	try {
+		preloaded = levelManager.IsPreloaded(levelName);
+		level = levelManager.Take(levelName, *curScene);
+		if (!level) {
+			level = levelManager.Build(levelName, *curScene);
 		}
+	} catch (const std::exception &e) {
+		std::cerr << "Errore caricamento livello: " << e.what() << "\n";
+		return;
+	}
 
-		// Pulizia oggetti esistenti
-		vObjects.clear();
-		vPortals.clear();
-		player->Reset();
+	// The level we leave keeps its objects, so switching back is immediate
+	if (curLevel) {
+		levelManager.Keep(curLevel, curLevelName);
+	}
+	curLevel = level;
+	curLevelName = levelName;
+
+	player->Reset();
+	player->SetPosition(level->playerStart);
+	GatherLevelObjects();
+	TrimLevelResources();
+
+	std::cout << "Oggetti caricati: " << vObjects.size() << "\n";
+	std::cout << "Portali caricati: " << vPortals.size() << "\n";
+	std::cout << "Risorse in caricamento: " << ResourceLoader::Pending() << "\n";
+	std::cout << "Cambio livello " << levelName << " in " << switchTimer.Stop() * 1000.0f << " ms ("
+	          << (preloaded ? "precaricato" : "sincrono") << ")\n";
+	PrintMemory("Memoria dopo il caricamento di " + levelName);
+}
 
-		// Carica gli oggetti dalla scena
-		curScene->Load(config, vObjects, vPortals, *player);
+void Engine::SpawnProps(int count) {
+	if (!curLevel || count <= 0) {
+		return;
+	}
+	// A grid facing the camera, a little ahead of it, at the player's scale
+	const Matrix4 camToWorld = player->CamToWorld();
+	const Vector3 dir = camToWorld.MulDirection(Vector3(0, 0, -1)).Normalized();
+	const int side = static_cast<int>(std::ceil(std::sqrt(static_cast<float>(count))));
+	const float spacing = GH_PROP_SIZE * 2.5f;
+	for (int i = 0; i < count; ++i) {
+		const float x = (static_cast<float>(i % side) - 0.5f * static_cast<float>(side - 1)) * spacing;
+		const float y = (static_cast<float>(i / side) - 0.5f * static_cast<float>(side - 1)) * spacing;
+		auto prop = curLevel->arena.Make<Prop>(i % 2 ? Prop::BALL : Prop::CRATE);
+		prop->scale = Vector3(GH_PROP_SIZE);
+		prop->p_scale = player->p_scale;
+		prop->SetPosition(camToWorld.MulPoint(Vector3(x, y, -1.0f - spacing)));
+		prop->velocity = dir * (GH_PROP_SPAWN_SPEED * player->p_scale);
+		curLevel->spawned.push_back(prop);
+		vObjects.push_back(prop);
+	}
+	store.Build(vObjects);
+	std::cout << "Oggetti dinamici: " << curLevel->spawned.size() << "\n";
+}
 
-		vObjects.push_back(player);
+void Engine::GatherLevelObjects() {
+	vObjects.clear();
+	vPortals.clear();
+	curLevel->Gather(vObjects, vPortals);
+	vObjects.push_back(player);
+	store.Build(vObjects);
+	std::vector<std::string> portalErrors;
+	portalGraph.Build(vPortals, portalErrors);
+	for (const std::string &error: portalErrors) {
+		std::cerr << "Livello " << curLevelName << ": " << error << "\n";
+	}
+}
 
-		std::cout << "Oggetti caricati: " << vObjects.size() << "\n";
-		std::cout << "Portali caricati: " << vPortals.size() << "\n";
-	} catch (const std::exception &e) {
-		std::cerr << "Errore caricamento livello: " << e.what() << "\n";
+void Engine::TrimLevelResources() {
+	const ResourceStats before = GetResourceStats();
+	BeginResourceUse();
+	curLevel->TouchResources();
+	levelManager.TouchResources();
+	TrimResources(GH_RESOURCE_BUDGET_MB << 20);
+	const ResourceStats &after = GetResourceStats();
+	if (after.evicted > before.evicted) {
+		std::cout << "Risorse rilasciate: " << after.evicted - before.evicted << " ("
+		          << (after.evictedBytes - before.evictedBytes) / 1024 << " KB)\n";
 	}
+}
 
-	// Fase di connessione avanzata
-	for (auto &conn: pendingPortalConnections) {
-		for (auto &targetPortal: vPortals) {
-			if (targetPortal->sourceTunnel == conn.targetTunnel &&
-			    targetPortal->doorNumber == conn.targetDoor) {
-				Portal::Connect(conn.portal, targetPortal);
-				break;
-			}
-		}
+void Engine::ReloadLevelIfChanged() {
+	if (!GH_LEVEL_HOT_RELOAD || !curLevel || !levelManager.PollChanged(curLevelName)) {
+		return;
+	}
+	Timer reloadTimer;
+	reloadTimer.Start();
+	if (levelManager.Reload(curLevelName, *curLevel, *curScene)) {
+		GatherLevelObjects();
+		std::cout << "Ricaricamento " << curLevelName << " in " << reloadTimer.Stop() * 1000.0f << " ms\n";
 	}
-	pendingPortalConnections.clear();
 }
 
-void Engine::Update() const {
-	// Check for shader updates
-	CheckForShaderUpdates();
+void Engine::Update() {
+	// Hold the simulation until the colliders of this level are loaded, uploads for
+	// preloaded or reloaded levels do not stop it
+	if (!store.SolidsLoaded()) {
+		return;
+	}
 
-	// Update
-	for (const auto &vObject: vObjects) {
-		assert(vObject.get());
-		vObject->Update();
+	// Update, only bodies have behaviour
+	for (const ObjectStore::Body &body: store.Bodies()) {
+		body.physical->Update();
 	}
 
 	// Collisions
 	// For each physics object
-	for (size_t i = 0; i < vObjects.size(); ++i) {
-		Physical *physical = vObjects[i]->AsPhysical();
-		if (!physical) { continue; }
+	const auto &hitSpheres = store.HitSpheres();
+	for (const ObjectStore::Body &body: store.Bodies()) {
+		Physical *physical = body.physical;
 		Matrix4 worldToLocal = physical->WorldToLocal();
 
 		// For each object to collide with
-		for (size_t j = 0; j < vObjects.size(); ++j) {
-			if (i == j) { continue; }
-			Object &obj = *vObjects[j];
-			if (!obj.mesh) { continue; }
+		for (const ObjectStore::Solid &solid: store.Solids()) {
+			if (solid.index == body.object || !ObjectStore::MayCollide(body, solid)) { continue; }
+			Object &obj = *solid.object;
+			const Mesh *mesh = obj.mesh.Get();
+			if (!mesh) { continue; }
 
 			// For each hit sphere
-			for (size_t s = 0; s < physical->hitSpheres.size(); ++s) {
+			for (uint32_t s = body.firstSphere; s < body.firstSphere + body.sphereCount; ++s) {
 				//Brings point from colliders local coordinates to hit's local coordinates.
-				const Sphere &sphere = physical->hitSpheres[s];
-				Matrix4 worldToUnit = sphere.LocalToUnit() * worldToLocal;
+				const Matrix4 &sphereLocalToUnit = hitSpheres[s].localToUnit;
+				Matrix4 worldToUnit = sphereLocalToUnit * worldToLocal;
 				Matrix4 localToUnit = worldToUnit * obj.LocalToWorld();
 				Matrix4 unitToWorld = worldToUnit.Inverse();
 
 				// For each collider
-				for (size_t c = 0; c < obj.mesh->colliders.size(); ++c) {
+				for (const Collider &collider: mesh->colliders) {
 					Vector3 push{};
-					const Collider &collider = obj.mesh->colliders[c];
 					if (collider.Collide(localToUnit, push)) {
 						//If push is too small, just ignore
 						push = unitToWorld.MulDirection(push);
-						vObjects[j]->OnHit(*physical, push);
-						physical->OnCollide(*vObjects[j], push);
+						obj.OnHit(*physical, push);
+						physical->OnCollide(obj, push);
 
 						worldToLocal = physical->WorldToLocal();
-						worldToUnit = sphere.LocalToUnit() * worldToLocal;
+						worldToUnit = sphereLocalToUnit * worldToLocal;
 						localToUnit = worldToUnit * obj.LocalToWorld();
 						unitToWorld = worldToUnit.Inverse();
 					}
@@ -186,17 +356,20 @@ void Engine::Update() const {
 		}
 	}
 
-	// Portals
-	for (const auto &vObject: vObjects) {
-		Physical *physical = vObject->AsPhysical();
-		if (physical) {
-			for (const auto &vPortal: vPortals) {
-				if (physical->TryPortal(*vPortal)) {
-					break;
-				}
+	// Portals, their warps follow any tunnel moved above
+	for (const auto &vPortal: vPortals) {
+		vPortal->RefreshWarps();
+	}
+	portalGraph.Refresh();
+	for (const ObjectStore::Body &body: store.Bodies()) {
+		for (const auto &vPortal: vPortals) {
+			if (body.physical->TryPortal(*vPortal)) {
+				break;
 			}
 		}
 	}
+
+	store.SyncTransforms();
 }
 
 void Engine::Render(const Camera &cam, GLuint curFBO, const Portal *skipPortal) const {
@@ -213,35 +386,43 @@ void Engine::Render(const Camera &cam, GLuint curFBO, const Portal *skipPortal)
 	}
 
 	// Draw scene
-	for (const auto &vObject: vObjects) {
-		vObject->Draw(cam, curFBO);
+	store.Draw(cam);
+
+	// Collider visualization, batched into a single draw per view
+	if (showColliders) {
+		store.DebugDraw(*debugLines);
+		debugLines->Flush(cam);
 	}
 
-	// Draw portals if possible
+	// Draw portals if possible, skipping the ones behind the portal this view looks out of
+	// and, inside portals, the ones no portal of the main view leads to
 	if (GH_REC_LEVEL > 0) {
+		const PortalGraph::PortalMask visible =
+				portalGraph.VisibleThrough(skipPortal, cam) & (skipPortal ? frameReach : ~PortalGraph::PortalMask(0));
+		const auto drawn = [&](size_t i) { return ((visible >> i) & 1) && vPortals[i].get() != skipPortal; };
 		// Draw portals
 		GH_REC_LEVEL -= 1;
 		if (occlusionCullingSupported && GH_REC_LEVEL > 0) {
-			glColorMask(GL_FALSE, GL_FALSE, GL_FALSE, GL_FALSE);
-			glDepthMask(GL_FALSE);
+			GLState::ColorMask(GL_FALSE, GL_FALSE, GL_FALSE, GL_FALSE);
+			GLState::DepthMask(GL_FALSE);
 			for (size_t i = 0; i < vPortals.size(); ++i) {
-				if (vPortals[i].get() != skipPortal) {
+				if (drawn(i)) {
 					glBeginQueryARB(GL_SAMPLES_PASSED_ARB, queries[i]);
 					vPortals[i]->DrawPink(cam);
 					glEndQueryARB(GL_SAMPLES_PASSED_ARB);
 				}
 			}
 			for (size_t i = 0; i < vPortals.size(); ++i) {
-				if (vPortals[i].get() != skipPortal) {
+				if (drawn(i)) {
 					glGetQueryObjectuivARB(queries[i], GL_QUERY_RESULT_ARB, &drawTest[i]);
 				}
 			};
-			glColorMask(GL_TRUE, GL_TRUE, GL_TRUE, GL_TRUE);
-			glDepthMask(GL_TRUE);
+			GLState::ColorMask(GL_TRUE, GL_TRUE, GL_TRUE, GL_TRUE);
+			GLState::DepthMask(GL_TRUE);
 			glDeleteQueriesARB(static_cast<GLsizei>(vPortals.size()), queries);
 		}
 		for (size_t i = 0; i < vPortals.size(); ++i) {
-			if (vPortals[i].get() != skipPortal) {
+			if (drawn(i)) {
 				if (occlusionCullingSupported && (GH_REC_LEVEL > 0) && (drawTest[i] == 0)) {
 					continue;
 				} else {
@@ -253,6 +434,72 @@ void Engine::Render(const Camera &cam, GLuint curFBO, const Portal *skipPortal)
 	}
 }
 
+bool Engine::RenderMultiview(const Camera &cam) {
+	constexpr int MAX_VIEWS = GH_MULTIVIEW_MAX_VIEWS;
+	const size_t numPortals = vPortals.size();
+
+	//Build the view tree breadth first, depth 0 is the main camera
+	mvViews[0].Clear();
+	mvViews[0].Add(cam, nullptr);
+	for (int d = 0; d < GH_MAX_RECURSION; ++d) {
+		const ViewSet &views = mvViews[d];
+		std::vector<int> &layers = mvPortalLayers[d];
+		layers.assign(numPortals * MAX_VIEWS, -1);
+		const bool last = (d == GH_MAX_RECURSION - 1);
+		if (!last) {
+			mvViews[d + 1].Clear();
+		}
+		const PortalGraph::PortalMask reach = d > 0 ? frameReach : ~PortalGraph::PortalMask(0);
+		for (int v = 0; v < views.Count(); ++v) {
+			const PortalGraph::PortalMask visible =
+					portalGraph.VisibleThrough(views.SkipPortal(v), views.GetCamera(v)) & reach;
+			for (size_t p = 0; p < numPortals; ++p) {
+				const Portal *portal = vPortals[p].get();
+				if (!((visible >> p) & 1) || portal == views.SkipPortal(v) ||
+				    !portal->InFrustum(views.GetCamera(v))) {
+					continue;
+				}
+				//Draw pink to indicate end of render chain
+				if (last) {
+					layers[p * MAX_VIEWS + v] = -2;
+					continue;
+				}
+				Camera portalCam;
+				const Portal *skip = portal->ViewCamera(views.GetCamera(v), portalCam);
+				const int layer = mvViews[d + 1].Add(portalCam, skip);
+				if (layer < 0) {
+					return false;
+				}
+				layers[p * MAX_VIEWS + v] = layer;
+			}
+		}
+	}
+
+	//Deepest views first, each depth samples the one below it
+	for (int d = GH_MAX_RECURSION - 1; d > 0; --d) {
+		if (mvViews[d].Count() == 0) {
+			continue;
+		}
+		mvBuffers[d - 1]->Reserve(mvViews[d].Count());
+		mvBuffers[d - 1]->Bind();
+		RenderViews(mvViews[d], mvPortalLayers[d], d + 1 < GH_MAX_RECURSION ? mvBuffers[d].get() : nullptr);
+	}
+
+	GLState::BindFramebuffer(0);
+	cam.UseViewport();
+	RenderViews(mvViews[0], mvPortalLayers[0], mvBuffers[0].get());
+	return true;
+}
+
+void Engine::RenderViews(const ViewSet &views, const std::vector<int> &portalLayers, const LayeredFrameBuffer *src) {
+	glClear(GL_DEPTH_BUFFER_BIT);
+	sky->DrawViews(views);
+	store.DrawViews(views);
+	for (size_t i = 0; i < vPortals.size(); ++i) {
+		vPortals[i]->DrawPortalViews(views, &portalLayers[i * GH_MULTIVIEW_MAX_VIEWS], src);
+	}
+}
+
 void Engine::InitGLObjects() {
 	// Debug info
 	std::cout << "OpenGL version: " << glGetString(GL_VERSION) << "\n";
@@ -266,19 +513,58 @@ void Engine::InitGLObjects() {
 	glEnable(GL_CULL_FACE);
 	glCullFace(GL_BACK);
 	glEnable(GL_DEPTH_TEST);
-	glDepthFunc(GL_LESS);
-	glDepthMask(GL_TRUE);
+	GLState::DepthFunc(GL_LESS);
+	GLState::DepthMask(GL_TRUE);
 
 	// Check GL functionality
 	glGetQueryiv(GL_SAMPLES_PASSED_ARB, GL_QUERY_COUNTER_BITS_ARB, &occlusionCullingSupported);
 
+	debugLines = std::make_unique<DebugLines>();
+
+	// Layered rendering writes gl_Layer from the vertex shader
+	multiviewSupported = GLEW_ARB_shader_viewport_layer_array;
+	useMultiview = GH_USE_MULTIVIEW && multiviewSupported;
+	for (auto &buffer: mvBuffers) {
+		buffer = std::make_unique<LayeredFrameBuffer>();
+	}
+	for (auto &buffer: portalBuffers) {
+		buffer = std::make_unique<FrameBuffer>();
+	}
+
 	EnableVSync();
 }
 
-void Engine::DestroyGLObjects() {
-	curScene->Unload();
+void Engine::PrintMemory(const std::string &title) const {
+	if (!curLevel) {
+		MemoryStats::Print(title);
+		return;
+	}
+	MemoryStats::Usage level[MemoryStats::NUM_CLASSES];
+	curLevel->MemoryUsage(level);
+	MemoryStats::Print(title + " (livello " + curLevelName + ")", level);
+}
+
+void Engine::DropLevel() {
+	store.Clear();
+	portalGraph.Clear();
 	vObjects.clear();
 	vPortals.clear();
+	curLevel.reset();
+}
+
+void Engine::DestroyGLObjects() {
+	ResourceLoader::Stop();
+	curScene->Unload();
+	DropLevel();
+	levelManager.Clear();
+	debugLines.reset();
+	for (auto &buffer: mvBuffers) {
+		buffer.reset();
+	}
+	for (auto &buffer: portalBuffers) {
+		buffer.reset();
+	}
+	ReleaseResources();
 }
 
 float Engine::NearestPortalDist() const {
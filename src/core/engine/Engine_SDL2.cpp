@@ -1,6 +1,7 @@
 #if not defined(_WIN32)
 #include "core/engine/Engine.h"
 #include "game/objects/base/Physical.h"
+#include "rendering/GLState.h"
 #include <SDL2/SDL.h>
 #include <GL/glew.h>
 #include <cmath>
@@ -121,6 +122,17 @@ int Engine::EnterMessageLoop() {
 			std::cout << "Shader reloaded\n";
 		} else if (input.key_press['f']) {
 			ToggleFullscreen();
+		} else if (input.key_press['C']) {
+			showColliders = !showColliders;
+		} else if (input.key_press['G']) {
+			GLState::PrintStats();
+		} else if (input.key_press['B']) {
+			PrintMemory("Memoria");
+		} else if (input.key_press['P']) {
+			SpawnProps(GH_PROP_SPAWN_COUNT);
+		} else if (input.key_press['M']) {
+			useMultiview = !useMultiview && multiviewSupported;
+			std::cout << "Multiview: " << (useMultiview ? "on" : "off") << "\n";
 		} else if (input.key_press['1']) {
 			LoadScene("l1-doubleTunnel");
 		} else if (input.key_press['2']) {
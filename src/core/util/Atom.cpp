@@ -0,0 +1,73 @@
+#include "core/util/Atom.h"
+#include "core/util/Hash.h"
+#include <deque>
+#include <mutex>
+#include <shared_mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace {
+	struct ViewHash {
+		size_t operator()(std::string_view str) const { return static_cast<size_t>(HashFNV64(str)); }
+	};
+
+	// Function static, atoms may be created during static initialization
+	struct Table {
+		std::shared_mutex mutex;
+		std::deque<std::string> text; // elements never move, the views below point into them
+		std::vector<std::string_view> views{std::string_view("", 0)};
+		std::unordered_map<std::string_view, uint32_t, ViewHash> ids;
+	};
+
+	Table &GetTable() {
+		static Table table;
+		return table;
+	}
+}
+
+Atom::Atom(std::string_view str) {
+	if (str.empty()) {
+		return;
+	}
+	Table &table = GetTable();
+	{
+		std::shared_lock lock(table.mutex);
+		if (const auto it = table.ids.find(str); it != table.ids.end()) {
+			id = it->second;
+			return;
+		}
+	}
+	std::unique_lock lock(table.mutex);
+	const auto [it, inserted] = table.ids.try_emplace(str, 0);
+	if (inserted) {
+		// Key the map with the stored copy, not with the caller's buffer
+		const std::string_view stored = table.text.emplace_back(str);
+		table.ids.erase(it);
+		const auto next = static_cast<uint32_t>(table.views.size());
+		table.ids.emplace(stored, next);
+		table.views.push_back(stored);
+		id = next;
+	} else {
+		id = it->second;
+	}
+}
+
+Atom Atom::Find(std::string_view str) {
+	Table &table = GetTable();
+	std::shared_lock lock(table.mutex);
+	const auto it = table.ids.find(str);
+	return it == table.ids.end() ? Atom() : Atom(it->second);
+}
+
+std::string_view Atom::View() const {
+	Table &table = GetTable();
+	std::shared_lock lock(table.mutex);
+	return table.views[id];
+}
+
+size_t Atom::Count() {
+	Table &table = GetTable();
+	std::shared_lock lock(table.mutex);
+	return table.views.size();
+}
@@ -0,0 +1,121 @@
+#include "core/util/FileWatcher.h"
+#include <algorithm>
+#include <chrono>
+
+#ifdef __linux__
+#include <poll.h>
+#include <sys/inotify.h>
+#include <unistd.h>
+#endif
+
+namespace {
+	// How long the thread sleeps between checks of the stop flag
+	constexpr int WAIT_MS = 100;
+	// Timestamp polling interval, when inotify is not available
+	constexpr int SCAN_MS = 500;
+}
+
+FileWatcher::FileWatcher(std::string directory) : directory(std::move(directory)) {
+#ifdef __linux__
+	inotifyFd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+	// Editors either rewrite the file or move a new one over it
+	if (inotifyFd >= 0 && inotify_add_watch(inotifyFd, this->directory.c_str(), IN_CLOSE_WRITE | IN_MOVED_TO) < 0) {
+		close(inotifyFd);
+		inotifyFd = -1;
+	}
+#endif
+	if (inotifyFd < 0) {
+		Scan(true);
+	}
+	thread = std::thread(&FileWatcher::Run, this);
+}
+
+FileWatcher::~FileWatcher() {
+	stopping = true;
+	thread.join();
+#ifdef __linux__
+	if (inotifyFd >= 0) {
+		close(inotifyFd);
+	}
+#endif
+}
+
+void FileWatcher::Poll(std::vector<std::string> &changed) {
+	if (!dirty.exchange(false)) {
+		return;
+	}
+	std::lock_guard<std::mutex> lock(mutex);
+	for (std::string &file: pending) {
+		changed.push_back(std::move(file));
+	}
+	pending.clear();
+}
+
+void FileWatcher::Post(std::string file) {
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		if (std::find(pending.begin(), pending.end(), file) == pending.end()) {
+			pending.push_back(std::move(file));
+		}
+	}
+	dirty = true;
+}
+
+void FileWatcher::Run() {
+#ifdef __linux__
+	if (inotifyFd >= 0) {
+		alignas(inotify_event) char buffer[4096];
+		pollfd fd{inotifyFd, POLLIN, 0};
+		while (!stopping) {
+			if (poll(&fd, 1, WAIT_MS) <= 0) {
+				continue;
+			}
+			ssize_t len;
+			while ((len = read(inotifyFd, buffer, sizeof(buffer))) > 0) {
+				for (char *cur = buffer; cur < buffer + len;) {
+					const auto *event = reinterpret_cast<const inotify_event *>(cur);
+					if (event->len > 0) {
+						Post(event->name);
+					}
+					cur += sizeof(inotify_event) + event->len;
+				}
+			}
+		}
+		return;
+	}
+#endif
+	auto nextScan = std::chrono::steady_clock::now();
+	while (!stopping) {
+		std::this_thread::sleep_for(std::chrono::milliseconds(WAIT_MS));
+		if (std::chrono::steady_clock::now() < nextScan) {
+			continue;
+		}
+		nextScan += std::chrono::milliseconds(SCAN_MS);
+		for (std::string &file: Scan(false)) {
+			Post(std::move(file));
+		}
+	}
+}
+
+std::vector<std::string> FileWatcher::Scan(bool initial) {
+	std::vector<std::string> changed;
+	std::error_code ec;
+	for (const auto &entry: std::filesystem::directory_iterator(directory, ec)) {
+		const auto time = entry.last_write_time(ec);
+		if (ec) {
+			continue;
+		}
+		const std::string file = entry.path().filename().string();
+		const auto it = timestamps.find(file);
+		if (it == timestamps.end()) {
+			timestamps.emplace(file, time);
+			if (!initial) {
+				changed.push_back(file);
+			}
+		} else if (it->second != time) {
+			it->second = time;
+			changed.push_back(file);
+		}
+	}
+	return changed;
+}
@@ -1,7 +1,7 @@
 #include "game/DefaultScene.h"
 
-void DefaultScene::Load(const LevelConfig &config, PObjectVec &objs, PPortalVec &portals, Player &player) {
-	Scene::Load(config, objs, portals, player);
+void DefaultScene::Load(const LevelConfig &config, Level &level) {
+	Scene::Load(config, level);
 }
 
 void DefaultScene::Unload() {
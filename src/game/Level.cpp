@@ -0,0 +1,94 @@
+#include "game/Level.h"
+#include "rendering/Mesh.h"
+#include "rendering/Shader.h"
+#include "rendering/Texture.h"
+#include "resources/Resources.h"
+#include <algorithm>
+#include <type_traits>
+#include <unordered_set>
+
+void Level::Gather(PObjectVec &objects, PPortalVec &portals) const {
+	for (const LevelObject &entry: entries) {
+		if (entry.object) {
+			objects.push_back(entry.object);
+		}
+		portals.insert(portals.end(), entry.portals.begin(), entry.portals.end());
+	}
+	objects.insert(objects.end(), spawned.begin(), spawned.end());
+}
+
+void Level::PackTextures() {
+	// Only objects drawn by the plain texture shader, the others have their own sampling
+	std::vector<std::string> names;
+	std::vector<Object *> packed;
+	for (const LevelObject &entry: entries) {
+		const auto &object = entry.object;
+		if (object && object->texture && object->shader && object->shader->GetName() == "texture" &&
+		    object->texture->IsPackable()) {
+			names.push_back(object->texture->GetName());
+			packed.push_back(object.get());
+		}
+	}
+	// Sorted, so levels using the same textures share the same array
+	std::sort(names.begin(), names.end());
+	names.erase(std::unique(names.begin(), names.end()), names.end());
+	if (names.size() < 2) {
+		return;
+	}
+
+	const auto array = AcquireTextureArray(names);
+	const auto shader = AcquireShader("texture_layer");
+	for (Object *object: packed) {
+		const auto layer = std::lower_bound(names.begin(), names.end(), object->texture->GetName());
+		object->textureLayer = static_cast<int>(layer - names.begin());
+		object->texture = array;
+		object->shader = shader;
+		object->mvShader = {};
+	}
+}
+
+namespace {
+	// f(handle) for the mesh and texture handles of every object, portal and spawned object
+	template<typename F>
+	void ForEachResource(const Level &level, F &&f) {
+		for (const LevelObject &entry: level.entries) {
+			if (entry.object) {
+				f(entry.object->mesh);
+				f(entry.object->texture);
+			}
+			for (const auto &portal: entry.portals) {
+				f(portal->mesh);
+			}
+		}
+		for (const auto &object: level.spawned) {
+			f(object->mesh);
+			f(object->texture);
+		}
+	}
+
+	template<typename T>
+	void Charge(Handle<T> handle, std::unordered_set<uint32_t> &seen, MemoryStats::Usage &usage) {
+		const T *resource = handle.Get();
+		if (resource && seen.insert(handle.Value()).second) {
+			usage.cpu += resource->CpuBytes();
+			usage.gpu += resource->GpuBytes();
+			usage.count += 1;
+		}
+	}
+}
+
+void Level::TouchResources() const {
+	ForEachResource(*this, [](auto handle) { TouchResource(handle); });
+}
+
+void Level::MemoryUsage(MemoryStats::Usage usage[MemoryStats::NUM_CLASSES]) const {
+	std::fill_n(usage, MemoryStats::NUM_CLASSES, MemoryStats::Usage());
+	std::unordered_set<uint32_t> meshes, textures;
+	ForEachResource(*this, [&](auto handle) {
+		if constexpr (std::is_same_v<decltype(handle), Handle<Mesh>>) {
+			Charge(handle, meshes, usage[MemoryStats::MESH]);
+		} else {
+			Charge(handle, textures, usage[MemoryStats::TEXTURE]);
+		}
+	});
+}
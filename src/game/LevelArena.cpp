@@ -0,0 +1,19 @@
+#include "game/LevelArena.h"
+#include "core/engine/GameHeader.h"
+
+LevelArena::LevelArena() : buffer(GH_LEVEL_ARENA_BLOCK, &upstream) {}
+
+void *LevelArena::do_allocate(size_t size, size_t align) {
+	allocations += 1;
+	bytes += size;
+	return buffer.allocate(size, align);
+}
+
+void *LevelArena::Upstream::do_allocate(size_t size, size_t align) {
+	blocks += 1;
+	return std::pmr::new_delete_resource()->allocate(size, align);
+}
+
+void LevelArena::Upstream::do_deallocate(void *p, size_t size, size_t align) {
+	std::pmr::new_delete_resource()->deallocate(p, size, align);
+}
@@ -1,83 +1,398 @@
 #include "game/LevelConfig.h"
+#include "core/engine/GameHeader.h"
+#include <yaml-cpp/yaml.h>
+#include <algorithm>
+#include <charconv>
+#include <cmath>
+#include <cstring>
+#include <filesystem>
 #include <fstream>
 #include <iostream>
+#include <stdexcept>
+#include <unordered_map>
 
-#include "core/engine/GameHeader.h"
+namespace {
+	struct BinaryHeader {
+		uint32_t magic;
+		uint32_t version;
+		uint32_t objectCount;
+		uint32_t stringCount;
+		uint32_t stringBytes;
+		uint32_t nameString;
+		float playerStart[3];
+	};
+
+	// Same values as Tunnel::Type
+	const std::unordered_map<std::string, uint8_t> TUNNEL_SUBTYPES = {
+			{"NORMAL", 0},
+			{"SCALE",  1},
+			{"SLOPE",  2}
+	};
+
+	// Same values as Prop::Type
+	const std::unordered_map<std::string, uint8_t> PROP_SUBTYPES = {
+			{"CRATE", 0},
+			{"BALL",  1}
+	};
+
+	bool ReadVector3(const YAML::Node &node, float out[3]) {
+		const auto values = node.as<std::vector<float>>();
+		if (values.size() < 3) {
+			return false;
+		}
+		std::copy_n(values.begin(), 3, out);
+		return true;
+	}
+
+	// "tunnel2.door1" -> ("tunnel2", 1). A number too large for an int gives door 0,
+	// which the caller reports as an invalid door.
+	bool ParseDoorRef(const std::string &ref, std::string_view &id, int &door) {
+		const size_t dotPos = ref.find('.');
+		if (dotPos == std::string::npos || ref.compare(dotPos + 1, 4, "door") != 0) {
+			return false;
+		}
+		id = std::string_view(ref).substr(0, dotPos);
+		const char *first = ref.data() + std::min(dotPos + 5, ref.size());
+		const char *last = ref.data() + ref.size();
+		if (first == last || *first == '-' || *first == '+') {
+			return false;
+		}
+		const auto [end, ec] = std::from_chars(first, last, door);
+		if (ec == std::errc::result_out_of_range) {
+			door = 0;
+			return end == last;
+		}
+		return ec == std::errc() && end == last;
+	}
+}
 
-LevelConfig::LevelConfig(const std::string &yamlPath) {
-	YAML::Node root = YAML::LoadFile(yamlPath);
-	ParseYAML(root);
+const char *ObjectTypeName(ObjectType type) {
+	switch (type) {
+		case ObjectType::Tunnel: return "Tunnel";
+		case ObjectType::Ground: return "Ground";
+		case ObjectType::Prop: return "Prop";
+	}
+	return "?";
 }
 
-void LevelConfig::ParseYAML(const YAML::Node &root) {
-	name = root["name"].as<std::string>("Unnamed Level");
+LevelConfig LevelConfig::Load(const std::string &yamlPath) {
+	const std::string binPath = BinaryPathFor(yamlPath);
+	LevelConfig config;
+	if (GH_USE_COMPILED_LEVELS && IsUpToDate(yamlPath, binPath) && FromBinary(binPath, config)) {
+		return config;
+	}
+	std::vector<std::string> errors;
+	config = FromYAML(yamlPath, errors);
+	config.Validate(errors);
+	for (const std::string &error: errors) {
+		std::cerr << yamlPath << ": " << error << "\n";
+	}
+	return config;
+}
+
+LevelConfig LevelConfig::FromYAML(const std::string &yamlPath, std::vector<std::string> &errors) {
+	const YAML::Node root = YAML::LoadFile(yamlPath);
+	LevelConfig config;
+	config.name = root["name"].as<std::string>("Unnamed Level");
 
 	// Player start con valori di default
-	if (root["player_start"]) {
-		player_start = root["player_start"].as<std::vector<float>>();
-	} else {
-		player_start = {0.0f, GH_PLAYER_HEIGHT, 0.0f}; // Valore di default sensato
+	config.player_start[0] = 0.0f;
+	config.player_start[1] = GH_PLAYER_HEIGHT; // Valore di default sensato
+	config.player_start[2] = 0.0f;
+	if (root["player_start"] && !ReadVector3(root["player_start"], config.player_start)) {
+		errors.emplace_back("player_start non valido, usando il default");
 	}
 
-	for (const auto &node: root["objects"]) {
-		ObjectConfig obj;
+	// I collegamenti si risolvono dopo, quando tutti gli id sono noti
+	struct PendingLink {
+		size_t object;
+		int door;
+		std::string target;
+	};
+	std::vector<PendingLink> links;
+	std::unordered_map<Atom, uint16_t> ids;
 
-		// Campo type obbligatorio
-		if (!node["type"]) {
-			std::cerr << "Oggetto senza tipo, saltato\n";
-			continue;
+	for (const auto &node: root["objects"]) {
+		const std::string where = "oggetto " + std::to_string(config.objects.size() + 1);
+		if (config.objects.size() >= UINT16_MAX) {
+			errors.push_back(where + ": troppi oggetti, saltato");
+			break;
 		}
-		obj.type = node["type"].as<std::string>();
+		try {
+			ObjectConfig obj{};
 
-		// Subtype con default
-		obj.subtype = node["subtype"].as<std::string>("");
+			// Campo type obbligatorio
+			if (!node["type"]) {
+				errors.push_back(where + ": senza tipo, saltato");
+				continue;
+			}
+			const auto type = node["type"].as<std::string>();
+			const auto subtype = node["subtype"].as<std::string>("");
+			if (type == "Tunnel") {
+				const auto it = TUNNEL_SUBTYPES.find(subtype);
+				if (it == TUNNEL_SUBTYPES.end()) {
+					errors.push_back(where + ": subtype Tunnel non valido '" + subtype + "', saltato");
+					continue;
+				}
+				obj.type = ObjectType::Tunnel;
+				obj.subtype = it->second;
+			} else if (type == "Ground") {
+				obj.type = ObjectType::Ground;
+				obj.subtype = (subtype == "SLOPE") ? 1 : 0;
+			} else if (type == "Prop") {
+				const auto it = PROP_SUBTYPES.find(subtype.empty() ? "CRATE" : subtype);
+				if (it == PROP_SUBTYPES.end()) {
+					errors.push_back(where + ": subtype Prop non valido '" + subtype + "', saltato");
+					continue;
+				}
+				obj.type = ObjectType::Prop;
+				obj.subtype = it->second;
+			} else {
+				errors.push_back(where + ": tipo sconosciuto '" + type + "', saltato");
+				continue;
+			}
 
-		// ID con default
-		obj.id = node["id"].as<std::string>("");
+			// ID con default, internato
+			const Atom id(node["id"].as<std::string>(""));
+			if (!id.Empty()) {
+				if (!ids.emplace(id, static_cast<uint16_t>(config.objects.size())).second) {
+					errors.push_back(where + ": id duplicato '" + std::string(id.View()) + "'");
+				}
+				obj.id = static_cast<uint32_t>(config.strings.size());
+				config.strings.push_back(id);
+			}
 
-		// Position con default
-		if (node["position"]) {
-			obj.position = node["position"].as<std::vector<float>>();
-		} else {
-			obj.position = {0.0f, 0.0f, 0.0f};
-		}
+			// Position con default
+			if (node["position"] && !ReadVector3(node["position"], obj.position)) {
+				errors.push_back(where + ": position non valida, usando (0,0,0)");
+			}
 
-		// Scale con controllo dimensioni
-		if (node["scale"]) {
-			if (node["scale"].IsScalar()) {
-				auto scale = node["scale"].as<float>(1.0f);
-				obj.scale = {scale, scale, scale};
-			} else {
-				auto vec_scale = node["scale"].as<std::vector<float>>();
-				if (vec_scale.size() == 1) {
-					obj.scale = {vec_scale[0], vec_scale[0], vec_scale[0]};
-				} else if (vec_scale.size() >= 3) {
-					obj.scale = {vec_scale[0], vec_scale[1], vec_scale[2]};
+			// Scale con controllo dimensioni
+			std::fill_n(obj.scale, 3, 1.0f);
+			if (node["scale"]) {
+				if (node["scale"].IsScalar()) {
+					std::fill_n(obj.scale, 3, node["scale"].as<float>(1.0f));
 				} else {
-					std::cerr << "Scala non valida per oggetto " << obj.id
-					          << ", usando default (1,1,1)\n";
-					obj.scale = {1.0f, 1.0f, 1.0f};
+					auto vec_scale = node["scale"].as<std::vector<float>>();
+					if (vec_scale.size() == 1) {
+						std::fill_n(obj.scale, 3, vec_scale[0]);
+					} else if (vec_scale.size() >= 3) {
+						std::copy_n(vec_scale.begin(), 3, obj.scale);
+					} else {
+						errors.push_back(where + ": scala non valida, usando default (1,1,1)");
+					}
 				}
 			}
-		} else {
-			obj.scale = {1.0f, 1.0f, 1.0f};
+
+			// Rotation con default
+			if (node["rotation"] && !ReadVector3(node["rotation"], obj.rotation)) {
+				errors.push_back(where + ": rotation non valida, usando (0,0,0)");
+			}
+
+			// Portals con controllo
+			for (const auto &portal: node["portals"]) {
+				links.push_back({config.objects.size(), portal["door"].as<int>(0),
+				                 portal["connects_to"].as<std::string>("")});
+			}
+
+			config.objects.push_back(obj);
+		} catch (const YAML::Exception &e) {
+			errors.push_back(where + ": " + e.what() + ", saltato");
 		}
+	}
 
-		// Rotation con default
-		if (node["rotation"]) {
-			auto rot = node["rotation"].as<std::vector<float>>();
-			if (rot.size() >= 3) {
-				obj.rotation = {rot[0], rot[1], rot[2]};
+	// Risoluzione dei collegamenti tra porte
+	for (const PendingLink &link: links) {
+		ObjectConfig &obj = config.objects[link.object];
+		const std::string where =
+				"oggetto " + std::string(config.strings[obj.id].View()) + " porta " + std::to_string(link.door);
+		std::string_view targetId;
+		int targetDoor = 0;
+		if (obj.type != ObjectType::Tunnel) {
+			errors.push_back(where + ": solo i Tunnel hanno porte");
+			continue;
+		}
+		if (link.door < 1 || link.door > ObjectConfig::MAX_PORTALS) {
+			errors.push_back(where + ": numero di porta non valido");
+			continue;
+		}
+		if (!ParseDoorRef(link.target, targetId, targetDoor)) {
+			errors.push_back(where + ": formato connects_to non valido '" + link.target + "'");
+			continue;
+		}
+		const auto target = ids.find(Atom::Find(targetId));
+		if (target == ids.end() || config.objects[target->second].type != ObjectType::Tunnel) {
+			errors.push_back(where + ": tunnel di destinazione inesistente '" + std::string(targetId) + "'");
+			continue;
+		}
+		if (targetDoor < 1 || targetDoor > ObjectConfig::MAX_PORTALS) {
+			errors.push_back(where + ": porta di destinazione non valida '" + link.target + "'");
+			continue;
+		}
+		bool duplicate = false;
+		for (int i = 0; i < obj.portalCount; ++i) {
+			duplicate |= (obj.portals[i].door == link.door);
+		}
+		if (duplicate) {
+			errors.push_back(where + ": porta collegata piu' volte");
+			continue;
+		}
+		obj.portals[obj.portalCount++] = {static_cast<uint8_t>(link.door), static_cast<uint8_t>(targetDoor),
+		                                  target->second};
+	}
+	return config;
+}
+
+void LevelConfig::Validate(std::vector<std::string> &errors) const {
+	for (const float v: player_start) {
+		if (!std::isfinite(v)) {
+			errors.emplace_back("player_start non finito");
+		}
+	}
+	for (size_t i = 0; i < objects.size(); ++i) {
+		const ObjectConfig &obj = objects[i];
+		const std::string where = "oggetto " + std::to_string(i + 1) + " (" + std::string(strings[obj.id].View()) + ")";
+		for (int k = 0; k < 3; ++k) {
+			if (!std::isfinite(obj.position[k]) || !std::isfinite(obj.rotation[k]) || !std::isfinite(obj.scale[k])) {
+				errors.push_back(where + ": valori non finiti");
+				break;
+			}
+			if (obj.scale[k] == 0.0f) {
+				errors.push_back(where + ": scala nulla");
+				break;
+			}
+		}
+		// Connect links both ways, so the other door must point back here
+		for (int p = 0; p < obj.portalCount; ++p) {
+			const PortalLink &link = obj.portals[p];
+			const ObjectConfig &target = objects[link.targetObject];
+			bool reciprocal = false;
+			for (int q = 0; q < target.portalCount; ++q) {
+				reciprocal |= target.portals[q].door == link.targetDoor && target.portals[q].targetObject == i &&
+				              target.portals[q].targetDoor == link.door;
+			}
+			if (!reciprocal) {
+				errors.push_back(where + " porta " + std::to_string(link.door) + ": collegamento non reciproco con " +
+				                 std::string(strings[target.id].View()) + ".door" + std::to_string(link.targetDoor));
 			}
+		}
+	}
+}
+
+bool LevelConfig::FromBinary(const std::string &path, LevelConfig &config) {
+	std::ifstream file(path, std::ios::binary | std::ios::ate);
+	if (!file) {
+		return false;
+	}
+	const auto size = static_cast<size_t>(file.tellg());
+	std::vector<char> bytes(size);
+	file.seekg(0);
+	if (!file.read(bytes.data(), static_cast<std::streamsize>(size))) {
+		return false;
+	}
+
+	BinaryHeader header{};
+	if (size < sizeof(header)) {
+		return false;
+	}
+	std::memcpy(&header, bytes.data(), sizeof(header));
+	const size_t objectsOffset = sizeof(header);
+	const size_t offsetsOffset = objectsOffset + sizeof(ObjectConfig) * header.objectCount;
+	const size_t charsOffset = offsetsOffset + sizeof(uint32_t) * (header.stringCount + static_cast<size_t>(1));
+	if (header.magic != MAGIC || header.version != VERSION || header.stringCount < 2 ||
+	    header.nameString != header.stringCount - 1 || size != charsOffset + header.stringBytes) {
+		std::cerr << "Livello compilato non valido: " << path << "\n";
+		return false;
+	}
+
+	config.objects.resize(header.objectCount);
+	std::memcpy(config.objects.data(), bytes.data() + objectsOffset, sizeof(ObjectConfig) * header.objectCount);
+	std::vector<uint32_t> offsets(header.stringCount + 1);
+	std::memcpy(offsets.data(), bytes.data() + offsetsOffset, sizeof(uint32_t) * offsets.size());
+	config.strings.clear();
+	for (uint32_t i = 0; i < header.stringCount; ++i) {
+		if (offsets[i] > offsets[i + 1] || offsets[i + 1] > header.stringBytes) {
+			std::cerr << "Livello compilato non valido: " << path << "\n";
+			return false;
+		}
+		const std::string_view str(bytes.data() + charsOffset + offsets[i], offsets[i + 1] - offsets[i]);
+		if (i == header.nameString) {
+			config.name = str;
 		} else {
-			obj.rotation = {0.0f, 0.0f, 0.0f};
+			config.strings.emplace_back(str);
+		}
+	}
+	for (const ObjectConfig &obj: config.objects) {
+		bool valid = obj.id < header.nameString && obj.portalCount <= ObjectConfig::MAX_PORTALS &&
+		             (obj.type == ObjectType::Ground || (obj.type == ObjectType::Tunnel && obj.subtype <= 2) ||
+		              (obj.type == ObjectType::Prop && obj.subtype <= 1));
+		for (int i = 0; valid && i < obj.portalCount; ++i) {
+			valid = obj.portals[i].targetObject < header.objectCount;
+		}
+		if (!valid) {
+			std::cerr << "Livello compilato non valido: " << path << "\n";
+			return false;
 		}
+	}
+	std::copy_n(header.playerStart, 3, config.player_start);
+	return true;
+}
+
+bool LevelConfig::WriteBinary(const std::string &path) const {
+	// The level name goes at the end of the string table
+	std::vector<uint32_t> offsets{0};
+	std::string chars;
+	for (const Atom str: strings) {
+		chars += str.View();
+		offsets.push_back(static_cast<uint32_t>(chars.size()));
+	}
+	chars += name;
+	offsets.push_back(static_cast<uint32_t>(chars.size()));
+
+	BinaryHeader header{};
+	header.magic = MAGIC;
+	header.version = VERSION;
+	header.objectCount = static_cast<uint32_t>(objects.size());
+	header.stringCount = static_cast<uint32_t>(strings.size() + 1);
+	header.stringBytes = static_cast<uint32_t>(chars.size());
+	header.nameString = static_cast<uint32_t>(strings.size());
+	std::copy_n(player_start, 3, header.playerStart);
 
-		// Portals con controllo
-		if (node["portals"]) {
-			obj.portals = node["portals"].as<std::vector<YAML::Node>>();
+	// Write to a temporary file first so the engine never reads a truncated level
+	const std::string tmpPath = path + ".tmp";
+	{
+		std::ofstream file(tmpPath, std::ios::binary | std::ios::trunc);
+		file.write(reinterpret_cast<const char *>(&header), sizeof(header));
+		file.write(reinterpret_cast<const char *>(objects.data()),
+		           static_cast<std::streamsize>(sizeof(ObjectConfig) * objects.size()));
+		file.write(reinterpret_cast<const char *>(offsets.data()),
+		           static_cast<std::streamsize>(sizeof(uint32_t) * offsets.size()));
+		file.write(chars.data(), static_cast<std::streamsize>(chars.size()));
+		if (!file) {
+			std::cerr << "Failed to write compiled level: " << tmpPath << "\n";
+			return false;
 		}
+	}
+	std::error_code ec;
+	std::filesystem::rename(tmpPath, path, ec);
+	if (ec) {
+		std::cerr << "Failed to write compiled level: " << path << " (" << ec.message() << ")\n";
+		return false;
+	}
+	return true;
+}
+
+std::string LevelConfig::BinaryPathFor(const std::string &yamlPath) {
+	return std::filesystem::path(yamlPath).replace_extension(".nlevel").string();
+}
 
-		objects.push_back(obj);
+bool LevelConfig::IsUpToDate(const std::string &yamlPath, const std::string &binPath) {
+	std::error_code ec;
+	const auto binTime = std::filesystem::last_write_time(binPath, ec);
+	if (ec) {
+		return false;
 	}
+	// A compiled level without its source is always usable
+	const auto yamlTime = std::filesystem::last_write_time(yamlPath, ec);
+	return ec || binTime >= yamlTime;
 }
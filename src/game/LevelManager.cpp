@@ -1,9 +1,172 @@
 #include "game/LevelManager.h"
+#include "core/engine/GameHeader.h"
+#include "game/Scene.h"
+#include "resources/Resources.h"
+#include <chrono>
+#include <filesystem>
+#include <iostream>
 
 void LevelManager::RegisterLevel(const std::string &name, const std::string &yamlPath) {
+	if (levelPaths.find(name) == levelPaths.end()) {
+		levelNames.push_back(name);
+	}
 	levelPaths[name] = yamlPath;
 }
 
 LevelConfig LevelManager::LoadConfig(const std::string &levelName) {
-	return LevelConfig(levelPaths.at(levelName));
-}
\ No newline at end of file
+	return LevelConfig::Load(levelPaths.at(levelName));
+}
+
+void LevelManager::Preload(const std::string &levelName) {
+	if (IsPreloaded(levelName) || parsing.count(levelName) > 0) {
+		return;
+	}
+	// Level parsing needs no GL and no engine state, so it can run on its own thread
+	const std::string path = levelPaths.at(levelName);
+	parsing[levelName] = std::async(std::launch::async, [path] { return LevelConfig::Load(path); });
+}
+
+void LevelManager::Update(Scene &scene) {
+	for (auto it = parsing.begin(); it != parsing.end(); ++it) {
+		if (it->second.wait_for(std::chrono::seconds(0)) != std::future_status::ready) {
+			continue;
+		}
+		// Objects acquire shaders and queue their meshes and textures, so they are built on the GL thread
+		const std::string name = it->first;
+		std::future<LevelConfig> config = std::move(it->second);
+		parsing.erase(it);
+		try {
+			ready[name] = BuildFromConfig(config.get(), scene);
+			std::cout << "Livello precaricato: " << name << "\n";
+		} catch (const std::exception &e) {
+			std::cerr << "Errore precaricamento livello " << name << ": " << e.what() << "\n";
+		}
+		return;
+	}
+}
+
+std::shared_ptr<Level> LevelManager::Take(const std::string &levelName, Scene &scene) {
+	if (const auto it = ready.find(levelName); it != ready.end()) {
+		std::shared_ptr<Level> level = std::move(it->second);
+		ready.erase(it);
+		std::erase(kept, levelName);
+		return level;
+	}
+	if (const auto it = parsing.find(levelName); it != parsing.end()) {
+		std::future<LevelConfig> config = std::move(it->second);
+		parsing.erase(it);
+		return BuildFromConfig(config.get(), scene);
+	}
+	return nullptr;
+}
+
+std::shared_ptr<Level> LevelManager::Build(const std::string &levelName, Scene &scene) {
+	return BuildFromConfig(LoadConfig(levelName), scene);
+}
+
+void LevelManager::Keep(const std::shared_ptr<Level> &level, const std::string &levelName) {
+	ready[levelName] = level;
+	std::erase(kept, levelName);
+	kept.push_back(levelName);
+	while (kept.size() > GH_KEPT_LEVELS) {
+		ready.erase(kept.front());
+		kept.erase(kept.begin());
+	}
+}
+
+void LevelManager::TouchResources() const {
+	for (const auto &entry: ready) {
+		entry.second->TouchResources();
+	}
+}
+
+bool LevelManager::IsPreloaded(const std::string &levelName) const {
+	return ready.count(levelName) > 0;
+}
+
+void LevelManager::Clear() {
+	for (auto &entry: parsing) {
+		entry.second.wait();
+	}
+	parsing.clear();
+	ready.clear();
+	kept.clear();
+}
+
+bool LevelManager::PollChanged(const std::string &activeLevel) {
+	const auto it = levelPaths.find(activeLevel);
+	if (it == levelPaths.end()) {
+		return false;
+	}
+	const std::filesystem::path path(it->second);
+	const std::string dir = path.parent_path().string();
+	if (!watcher || watchedDir != dir) {
+		watcher = std::make_unique<FileWatcher>(dir);
+		watchedDir = dir;
+	}
+
+	changedFiles.clear();
+	watcher->Poll(changedFiles);
+	bool changed = false;
+	for (const std::string &file: changedFiles) {
+		for (const auto &[name, levelPath]: levelPaths) {
+			if (std::filesystem::path(levelPath).filename() != file) {
+				continue;
+			}
+			if (name == activeLevel) {
+				changed = true;
+			} else if (ready.erase(name) > 0) {
+				std::erase(kept, name);
+				std::cout << "Livello modificato, precaricamento scartato: " << name << "\n";
+			}
+		}
+	}
+	return changed;
+}
+
+bool LevelManager::Reload(const std::string &levelName, Level &level, Scene &scene) {
+	const std::string &path = levelPaths.at(levelName);
+	std::vector<std::string> errors;
+	LevelConfig config;
+	try {
+		config = LevelConfig::FromYAML(path, errors);
+	} catch (const std::exception &e) {
+		// YAML errors and anything else the parser throws, the running level must survive it
+		errors.emplace_back(e.what());
+	}
+	if (errors.empty()) {
+		config.Validate(errors);
+	}
+	// A half edited file leaves the running level as it is
+	if (!errors.empty()) {
+		for (const std::string &error: errors) {
+			std::cerr << path << ": " << error << "\n";
+		}
+		std::cerr << "Ricaricamento di " << levelName << " annullato\n";
+		return false;
+	}
+
+	scene.Reload(config, level);
+	if (GH_PACK_LEVEL_TEXTURES) {
+		level.PackTextures();
+	}
+	return true;
+}
+
+std::shared_ptr<Level> LevelManager::BuildFromConfig(const LevelConfig &config, Scene &scene) {
+	std::cout << "Caricamento livello: " << config.name << "\n";
+	std::cout << "Oggetti da caricare: " << config.objects.size() << "\n";
+	if (config.objects.empty()) {
+		std::cerr << "Attenzione: livello senza oggetti!\n";
+	}
+	const ResourceStats before = GetResourceStats();
+	auto level = std::make_shared<Level>();
+	scene.Load(config, *level);
+	if (GH_PACK_LEVEL_TEXTURES) {
+		level->PackTextures();
+	}
+	const ResourceStats &after = GetResourceStats();
+	std::cout << "Risorse " << config.name << ": " << after.hits - before.hits << " gia' caricate, "
+	          << after.misses - before.misses << " da caricare\n";
+	return level;
+}
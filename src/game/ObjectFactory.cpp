@@ -1,85 +1,65 @@
 #include "game/ObjectFactory.h"
-#include "core/engine/Engine.h"
 #include "game/objects/environment/Ground.h"
+#include "game/objects/props/Prop.h"
 #include "game/objects/props/Tunnel.h"
+#include <iostream>
 
-std::shared_ptr<Object> ObjectFactory::Create(const ObjectConfig &config) {
-	std::cout << "Creazione oggetto - Tipo: " << config.type
-	          << ", Subtype: " << config.subtype
-	          << ", ID: " << config.id << "\n";
-	try {
-		if (config.type == "Tunnel") {
-			auto tunnel = std::make_shared<Tunnel>(Tunnel::TypeFromString(config.subtype));
+// LevelConfig stores the tunnel subtype as a Tunnel::Type
+static_assert(Tunnel::NORMAL == 0 && Tunnel::SCALE == 1 && Tunnel::SLOPE == 2, "Tunnel::Type values");
+static_assert(Prop::CRATE == 0 && Prop::BALL == 1, "Prop::Type values");
 
-			// Controllo dimensione position
-			if (config.position.size() < 3) {
-				throw std::runtime_error("Position non valida per Tunnel");
-			}
-			tunnel->pos = Vector3(config.position[0], config.position[1], config.position[2]);
+std::shared_ptr<Object> ObjectFactory::Create(const ObjectConfig &config, Atom id, LevelArena &arena,
+                                              PPortalVec &portals) {
+	std::cout << "Creazione oggetto - Tipo: " << ObjectTypeName(config.type)
+	          << ", Subtype: " << static_cast<int>(config.subtype)
+	          << ", ID: " << id.View() << "\n";
 
-			// Controllo dimensione scale
-			if (config.scale.size() < 3) {
-				throw std::runtime_error("Scale non valida per Tunnel");
-			}
-			tunnel->scale = Vector3(config.scale[0], config.scale[1], config.scale[2]);
+	// Position, scale e rotation sono gia' validate da LevelConfig
+	std::shared_ptr<Object> object;
+	try {
+		switch (config.type) {
+			case ObjectType::Tunnel: {
+				auto tunnel = arena.Make<Tunnel>(static_cast<Tunnel::Type>(config.subtype));
+				Place(config, *tunnel, {});
 
-			// Controllo dimensione rotation
-			if (config.rotation.size() < 3) {
-				throw std::runtime_error("Rotation non valida per Tunnel");
+				// Crea i portali per il tunnel, collegati a fine caricamento
+				tunnel->CreatePortals(portals, id, arena);
+				object = tunnel;
+				break;
 			}
-			tunnel->euler = Vector3(config.rotation[0], config.rotation[1], config.rotation[2]);
-
-
-			// Crea i portali per il tunnel
-			std::vector<std::shared_ptr<Portal>> tunnelPortals;
-			tunnel->CreatePortals(tunnelPortals, config.id);
-
-			// Gestione connessioni
-			for (const auto &portalConfig: config.portals) {
-				int door = portalConfig["door"].as<int>();
-				auto target = portalConfig["connects_to"].as<std::string>();
-
-				// Trova il portale corrispondente a questa porta
-				for (auto &portal: tunnelPortals) {
-					if (portal->doorNumber == door) {
-						size_t dotPos = target.find('.');
-						if (dotPos == std::string::npos) {
-							std::cerr << "Formato connects_to non valido: " << target << std::endl;
-							continue;
-						}
-						portal->connectedTunnel = target.substr(0, dotPos);
-						portal->connectedDoor = std::stoi(target.substr(dotPos + 5)); // "doorX"
-
-						// Aggiungi alla lista di connessioni pendenti
-						GH_ENGINE->AddPortalConnection(portal, portal->connectedTunnel, portal->connectedDoor);
-					}
-				}
+			case ObjectType::Ground: {
+				auto ground = arena.Make<Ground>(config.subtype == 1);
+				Place(config, *ground, {});
+				object = ground;
+				break;
 			}
-
-			// Aggiungi i portali alla lista globale
-			for (auto &portal: tunnelPortals) {
-				GH_ENGINE->AddPortal(portal);
+			case ObjectType::Prop: {
+				auto prop = arena.Make<Prop>(static_cast<Prop::Type>(config.subtype));
+				Place(config, *prop, {});
+				object = prop;
+				break;
 			}
-
-			return tunnel;
 		}
-		if (config.type == "Ground") {
-			bool slope = (config.subtype == "SLOPE");
-			auto ground = std::make_shared<Ground>(slope);
+	} catch (const std::exception &e) {
+		std::cerr << "Errore creazione: " << e.what() << "\n";
+	}
+	return object;
+}
 
-			if (config.position.size() >= 3) {
-				ground->pos = Vector3(config.position[0], config.position[1], config.position[2]);
-			}
-			if (config.scale.size() >= 3) {
-				ground->scale = Vector3(config.scale[0], config.scale[1], config.scale[2]);
-			}
-			if (config.rotation.size() >= 3) {
-				ground->euler = Vector3(config.rotation[0], config.rotation[1], config.rotation[2]);
+void ObjectFactory::Place(const ObjectConfig &config, Object &object, const PPortalVec &portals) {
+	object.pos = Vector3(config.position[0], config.position[1], config.position[2]);
+	object.scale = Vector3(config.scale[0], config.scale[1], config.scale[2]);
+	object.euler = Vector3(config.rotation[0], config.rotation[1], config.rotation[2]);
+
+	// Le porte seguono il tunnel, ma la loro dimensione dipende dalla scala
+	if (config.type == ObjectType::Tunnel) {
+		const auto &tunnel = static_cast<const Tunnel &>(object);
+		for (const auto &portal: portals) {
+			if (portal->doorNumber == 1) {
+				tunnel.SetDoor1(*portal);
+			} else {
+				tunnel.SetDoor2(*portal);
 			}
-			return ground;
 		}
-	} catch (const std::exception &e) {
-		std::cerr << "Errore creazione: " << e.what() << "\n";
 	}
-	return nullptr;
 }
@@ -0,0 +1,174 @@
+#include "game/ObjectStore.h"
+#include "core/camera/Camera.h"
+#include "game/objects/base/Physical.h"
+#include "rendering/Mesh.h"
+#include "rendering/Shader.h"
+#include "rendering/Texture.h"
+#include "rendering/ViewSet.h"
+#include "resources/Resources.h"
+#include <algorithm>
+#include <cmath>
+#include <tuple>
+
+namespace {
+	// Largest factor the matrix stretches a length by, for bounding spheres
+	float MaxScale(const Matrix4 &m) {
+		return std::sqrt(std::max({m.XAxis().MagSq(), m.YAxis().MagSq(), m.ZAxis().MagSq()}));
+	}
+}
+
+void ObjectStore::Build(const PObjectVec &objectVec) {
+	Clear();
+	objects.reserve(objectVec.size());
+	for (const auto &object: objectVec) {
+		const auto index = static_cast<uint32_t>(objects.size());
+		objects.push_back(object.get());
+
+		// Bodies only collide with the static level, not with each other
+		if (object->mesh) {
+			if (!object->AsPhysical()) {
+				solids.push_back({object.get(), index, Vector3(0.0f), -1.0f, 0});
+			}
+			if (object->shader) {
+				renderables.push_back({object->shader, object->texture, object->mesh, object->textureLayer, index});
+			}
+		}
+
+		if (Physical *physical = object->AsPhysical()) {
+			const auto body = static_cast<uint32_t>(bodies.size());
+			float radius = 0.0f;
+			for (const Sphere &sphere: physical->hitSpheres) {
+				hitSpheres.push_back({sphere.LocalToUnit(), body});
+				radius = std::max(radius, sphere.center.Mag() + sphere.radius);
+			}
+			bodies.push_back({physical, index, static_cast<uint32_t>(hitSpheres.size() - physical->hitSpheres.size()),
+			                  static_cast<uint32_t>(physical->hitSpheres.size()), radius});
+		}
+	}
+
+	std::sort(renderables.begin(), renderables.end(), [](const Renderable &a, const Renderable &b) {
+		return std::tuple(a.shader.Value(), a.texture.Value(), a.layer) <
+		       std::tuple(b.shader.Value(), b.texture.Value(), b.layer);
+	});
+	mvShaders.resize(renderables.size());
+
+	localToWorld.resize(objects.size());
+	normalMatrix.resize(objects.size());
+	versions.assign(objects.size(), 0);
+	SyncTransforms();
+}
+
+void ObjectStore::Clear() {
+	objects.clear();
+	localToWorld.clear();
+	normalMatrix.clear();
+	versions.clear();
+	renderables.clear();
+	mvShaders.clear();
+	bodies.clear();
+	hitSpheres.clear();
+	solids.clear();
+}
+
+void ObjectStore::SyncTransforms() {
+	// Versions start at 1 once the matrices are built, so 0 forces the first copy
+	for (size_t i = 0; i < objects.size(); ++i) {
+		const uint32_t version = objects[i]->TransformVersion();
+		if (version == versions[i]) {
+			continue;
+		}
+		versions[i] = version;
+		localToWorld[i] = objects[i]->LocalToWorld();
+		normalMatrix[i] = objects[i]->WorldToLocal().Transposed();
+	}
+	// Bounds wait for the mesh, then follow the transform
+	for (Solid &solid: solids) {
+		if (solid.radius >= 0.0f && solid.version == versions[solid.index]) {
+			continue;
+		}
+		const Mesh *mesh = solid.object->mesh.Get();
+		if (!mesh || !mesh->IsResident()) {
+			solid.radius = -1.0f;
+			continue;
+		}
+		const Matrix4 &m = localToWorld[solid.index];
+		solid.center = m.MulPoint((mesh->boundsMin + mesh->boundsMax) * 0.5f);
+		solid.radius = (mesh->boundsMax - mesh->boundsMin).Mag() * 0.5f * MaxScale(m);
+		solid.version = versions[solid.index];
+	}
+}
+
+bool ObjectStore::SolidsLoaded() const {
+	for (const Solid &solid: solids) {
+		const Mesh *mesh = solid.object->mesh.Get();
+		if (mesh && mesh->IsLoading()) {
+			return false;
+		}
+	}
+	return true;
+}
+
+bool ObjectStore::MayCollide(const Body &body, const Solid &solid) {
+	if (solid.radius < 0.0f) {
+		return true;
+	}
+	const Matrix4 &m = body.physical->LocalToWorld();
+	const float reach = solid.radius + body.radius * MaxScale(m);
+	return (m.Translation() - solid.center).MagSq() <= reach * reach;
+}
+
+void ObjectStore::Draw(const Camera &cam) const {
+	const Matrix4 viewProj = cam.Matrix();
+	for (const Renderable &r: renderables) {
+		Shader *shader = r.shader.Get();
+		Mesh *mesh = r.mesh.Get();
+		if (!shader || !mesh) {
+			continue;
+		}
+		// GLState skips the binds that did not change
+		shader->Use();
+		if (const Texture *texture = r.texture.Get()) {
+			texture->Use();
+		}
+		if (r.layer >= 0) {
+			shader->SetInt(UniformId("layer"), r.layer);
+		}
+		const Matrix4 mvp = viewProj * localToWorld[r.object];
+		shader->SetMVP(mvp.m, normalMatrix[r.object].m);
+		mesh->Draw();
+	}
+}
+
+void ObjectStore::DrawViews(const ViewSet &views) {
+	for (size_t i = 0; i < renderables.size(); ++i) {
+		const Renderable &r = renderables[i];
+		const Shader *base = r.shader.Get();
+		Mesh *mesh = r.mesh.Get();
+		if (!base || !mesh) {
+			continue;
+		}
+		if (!mvShaders[i]) {
+			mvShaders[i] = AcquireShader((base->GetName() + "_mv").c_str());
+		}
+		Shader &shader = *mvShaders[i];
+		shader.Use();
+		if (const Texture *texture = r.texture.Get()) {
+			texture->Use();
+		}
+		if (r.layer >= 0) {
+			shader.SetInt(UniformId("layer"), r.layer);
+		}
+		views.Bind(shader);
+		shader.SetMat4(UniformId("model"), localToWorld[r.object].m);
+		shader.SetMat4(UniformId("mv"), normalMatrix[r.object].m);
+		mesh->DrawInstanced(views.Count());
+	}
+}
+
+void ObjectStore::DebugDraw(DebugLines &lines) const {
+	for (const Solid &solid: solids) {
+		if (const Mesh *mesh = solid.object->mesh.Get()) {
+			mesh->DebugDraw(lines, localToWorld[solid.index]);
+		}
+	}
+}
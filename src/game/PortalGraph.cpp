@@ -0,0 +1,189 @@
+#include "game/PortalGraph.h"
+#include "core/camera/Camera.h"
+#include <algorithm>
+
+namespace {
+	// Portal::ViewCamera pulls the clip plane up to this far toward the camera
+	constexpr float CLIP_MARGIN = 0.1f;
+
+	uint64_t DoorKey(Atom tunnel, int door) {
+		return (static_cast<uint64_t>(tunnel.Id()) << 8) | static_cast<uint8_t>(door);
+	}
+
+	// "tunnel.doorN", as written in the level
+	std::string DoorName(Atom tunnel, int door) {
+		return std::string(tunnel.View()) + ".door" + std::to_string(door);
+	}
+}
+
+void PortalGraph::Build(const PPortalVec &portalVec, std::vector<std::string> &errors) {
+	Clear();
+	if (portalVec.size() > GH_MAX_PORTALS) {
+		errors.push_back("troppi portali: " + std::to_string(portalVec.size()));
+		return;
+	}
+	for (const auto &portal: portalVec) {
+		const auto index = static_cast<uint32_t>(portals.size());
+		portals.push_back(portal.get());
+		indices.emplace(portal.get(), index);
+		if (!doors.emplace(DoorKey(portal->sourceTunnel, portal->doorNumber), index).second) {
+			errors.push_back("porta duplicata " + DoorName(portal->sourceTunnel, portal->doorNumber));
+		}
+	}
+
+	// Connect pairs the front warp of one door with the back warp of the other
+	for (const Portal *portal: portals) {
+		const std::string name = DoorName(portal->sourceTunnel, portal->doorNumber);
+		const Portal::Warp *warps[2] = {&portal->front, &portal->back};
+		for (int side = 0; side < 2; ++side) {
+			const Portal *target = warps[side]->toPortal;
+			if (!target) {
+				errors.push_back("portale " + name + " non collegato");
+				continue;
+			}
+			if (indices.find(target) == indices.end()) {
+				errors.push_back("portale " + name + " collegato a un portale di un altro livello");
+				continue;
+			}
+			const Portal::Warp &reverse = side == 0 ? target->back : target->front;
+			if (reverse.toPortal != portal) {
+				errors.push_back("collegamento " + name + " -> " + DoorName(target->sourceTunnel, target->doorNumber) +
+				                 " non reciproco");
+			}
+		}
+	}
+
+	ComputeVisibility();
+}
+
+void PortalGraph::Clear() {
+	portals.clear();
+	indices.clear();
+	doors.clear();
+	versions.clear();
+	for (auto &masks: beyond) {
+		masks.clear();
+	}
+	for (auto &masks: reach) {
+		masks.clear();
+	}
+}
+
+void PortalGraph::Refresh() {
+	for (size_t i = 0; i < portals.size(); ++i) {
+		if (portals[i]->TransformVersion() != versions[i]) {
+			ComputeVisibility();
+			return;
+		}
+	}
+}
+
+void PortalGraph::ComputeVisibility() {
+	const size_t count = portals.size();
+	versions.resize(count);
+	for (size_t i = 0; i < count; ++i) {
+		versions[i] = portals[i]->TransformVersion();
+	}
+
+	// Portal corners, the quad spans [-1, 1] on its local x and y
+	std::vector<Vector3> corners(count * 4);
+	for (size_t i = 0; i < count; ++i) {
+		const Matrix4 &m = portals[i]->LocalToWorld();
+		for (int c = 0; c < 4; ++c) {
+			corners[i * 4 + c] = m.MulPoint(Vector3((c & 1) ? 1.0f : -1.0f, (c & 2) ? 1.0f : -1.0f, 0.0f));
+		}
+	}
+
+	// A camera in front of a portal sees what lies behind it, and the other way round
+	for (auto &masks: beyond) {
+		masks.assign(count, 0);
+	}
+	for (size_t e = 0; e < count; ++e) {
+		const Vector3 normal = portals[e]->Forward();
+		const Vector3 center = portals[e]->LocalToWorld().Translation();
+		for (size_t i = 0; i < count; ++i) {
+			if (i == e) {
+				continue;
+			}
+			for (int c = 0; c < 4; ++c) {
+				const float dist = (corners[i * 4 + c] - center).Dot(normal);
+				if (dist < CLIP_MARGIN) {
+					beyond[0][e] |= PortalMask(1) << i;
+				}
+				if (dist > -CLIP_MARGIN) {
+					beyond[1][e] |= PortalMask(1) << i;
+				}
+			}
+		}
+	}
+
+	// Looking into the front of a portal, the camera comes out in front of the target door.
+	// Build reports warps to portals of other levels, they lead nowhere here.
+	std::vector<PortalMask> next(count, 0);
+	for (size_t i = 0; i < count; ++i) {
+		const int front = IndexOf(portals[i]->front.toPortal);
+		const int back = IndexOf(portals[i]->back.toPortal);
+		if (front >= 0) {
+			next[i] |= beyond[0][front];
+		}
+		if (back >= 0) {
+			next[i] |= beyond[1][back];
+		}
+	}
+	reach[0] = next;
+	for (int d = 1; d < GH_MAX_RECURSION; ++d) {
+		reach[d] = reach[d - 1];
+		for (size_t i = 0; i < count; ++i) {
+			for (size_t j = 0; j < count; ++j) {
+				if (reach[d - 1][i] & (PortalMask(1) << j)) {
+					reach[d][i] |= next[j];
+				}
+			}
+		}
+	}
+}
+
+int PortalGraph::IndexOf(const Portal *portal) const {
+	const auto it = indices.find(portal);
+	return it == indices.end() ? -1 : static_cast<int>(it->second);
+}
+
+const Portal *PortalGraph::Find(Atom tunnel, int door) const {
+	const auto it = doors.find(DoorKey(tunnel, door));
+	return it == doors.end() ? nullptr : portals[it->second];
+}
+
+PortalGraph::PortalMask PortalGraph::VisibleThrough(const Portal *exit, const Camera &cam) const {
+	const int e = IndexOf(exit);
+	if (e < 0) {
+		return ~PortalMask(0);
+	}
+	const Vector3 camPos = cam.worldView.Inverse().Translation();
+	const bool front = (camPos - exit->LocalToWorld().Translation()).Dot(exit->Forward()) > 0.0f;
+	return beyond[front ? 0 : 1][e];
+}
+
+bool PortalGraph::Reachable(const Portal *from, const Portal *to, int depth) const {
+	const int i = IndexOf(from);
+	const int j = IndexOf(to);
+	if (i < 0 || j < 0 || depth <= 0) {
+		return false;
+	}
+	const int d = std::min(depth, GH_MAX_RECURSION) - 1;
+	return (reach[d][i] >> j) & 1;
+}
+
+PortalGraph::PortalMask PortalGraph::ReachableFrom(const Camera &cam, int depth) const {
+	// The frame draws the portals in view, each recursion draws what the previous one reached
+	PortalMask mask = 0;
+	const int d = std::min(depth, GH_MAX_RECURSION) - 2;
+	for (size_t i = 0; i < portals.size(); ++i) {
+		if (portals[i]->InFrustum(cam)) {
+			mask |= PortalMask(1) << i;
+			if (d >= 0) {
+				mask |= reach[d][i];
+			}
+		}
+	}
+	return mask;
+}
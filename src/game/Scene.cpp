@@ -1,29 +1,116 @@
 #include "game/Scene.h"
 #include "game/ObjectFactory.h"
+#include <cstring>
+#include <iostream>
+#include <unordered_map>
 
-void Scene::Load(const LevelConfig &config, PObjectVec &objs, PPortalVec &portals, Player &player) {
-	// Controllo player start
-	if (config.player_start.size() < 3) {
-		throw std::runtime_error("Player start non valido nel livello");
-	}
-	player.SetPosition(Vector3(
+void Scene::Load(const LevelConfig &config, Level &level) {
+	level.name = config.name;
+	level.playerStart = Vector3(
 			config.player_start[0],
 			config.player_start[1],
 			config.player_start[2]
-	));
+	);
+	level.config = config;
 
 	std::cout << "Inizio caricamento scena\n";
+	level.entries.assign(config.objects.size(), {});
+	for (size_t i = 0; i < config.objects.size(); ++i) {
+		BuildObject(config, i, level.arena, level.entries[i]);
+	}
+
+	// Fase di connessione dei portali, i collegamenti sono gia' risolti in indici
+	ConnectPortals(level);
+	std::cout << "Caricamento completato. Oggetti totali: " << level.entries.size() << "\n";
+	std::cout << "Arena livello: " << level.arena.Allocations() << " allocazioni, " << level.arena.Bytes() / 1024
+	          << " KB in " << level.arena.Blocks() << " blocchi\n";
+}
+
+void Scene::Reload(const LevelConfig &config, Level &level) {
+	std::unordered_map<Atom, size_t> oldIds;
+	for (size_t i = 0; i < level.config.objects.size(); ++i) {
+		const Atom id = level.config.Id(level.config.objects[i]);
+		if (!id.Empty()) {
+			oldIds.emplace(id, i);
+		}
+	}
+
+	int kept = 0, moved = 0, built = 0;
+	std::vector<LevelObject> entries(config.objects.size());
+	for (size_t i = 0; i < config.objects.size(); ++i) {
+		const ObjectConfig &obj = config.objects[i];
+		const auto it = oldIds.find(config.Id(obj));
+		if (it != oldIds.end()) {
+			const ObjectConfig &old = level.config.objects[it->second];
+			LevelObject &prev = level.entries[it->second];
+			if (prev.object && old.type == obj.type && old.subtype == obj.subtype) {
+				entries[i] = std::move(prev);
+				oldIds.erase(it);
+				// position, scale and rotation are contiguous
+				if (std::memcmp(old.position, obj.position, sizeof(float) * 9) != 0) {
+					ObjectFactory::Place(obj, *entries[i].object, entries[i].portals);
+					moved += 1;
+				} else {
+					kept += 1;
+				}
+				continue;
+			}
+		}
+		BuildObject(config, i, level.arena, entries[i]);
+		built += 1;
+	}
+	const size_t removed = level.config.objects.size() - kept - moved;
+
+	// What was not carried over is released here, the links to it are redone below
+	level.entries = std::move(entries);
+	level.config = config;
+	level.name = config.name;
+	level.playerStart = Vector3(config.player_start[0], config.player_start[1], config.player_start[2]);
+	ConnectPortals(level);
+
+	std::cout << "Livello ricaricato: " << kept << " invariati, " << moved << " spostati, " << built
+	          << " creati, " << removed << " rimossi\n";
+}
 
-	for (const auto &objConfig: config.objects) {
-		std::cout << "Processando oggetto: " << objConfig.type << "\n";
-		if (auto obj = ObjectFactory::Create(objConfig)) {
-			std::cout << "Oggetto creato con successo: " << objConfig.type
-			          << " a posizione (" << obj->pos.x << ", "
-			          << obj->pos.y << ", " << obj->pos.z << ")\n";
-			objs.push_back(obj);
-		} else {
-			std::cerr << "Fallita creazione oggetto: " << objConfig.type << "\n";
+void Scene::BuildObject(const LevelConfig &config, size_t index, LevelArena &arena, LevelObject &entry) {
+	const ObjectConfig &objConfig = config.objects[index];
+	std::cout << "Processando oggetto: " << ObjectTypeName(objConfig.type) << "\n";
+	entry.object = ObjectFactory::Create(objConfig, config.Id(objConfig), arena, entry.portals);
+	if (entry.object) {
+		std::cout << "Oggetto creato con successo: " << ObjectTypeName(objConfig.type)
+		          << " a posizione (" << entry.object->pos.x << ", "
+		          << entry.object->pos.y << ", " << entry.object->pos.z << ")\n";
+	} else {
+		std::cerr << "Fallita creazione oggetto: " << ObjectTypeName(objConfig.type) << "\n";
+	}
+}
+
+void Scene::ConnectPortals(Level &level) {
+	const auto findDoor = [&](size_t object, int door) -> std::shared_ptr<Portal> {
+		for (const auto &portal: level.entries[object].portals) {
+			if (portal->doorNumber == door) {
+				return portal;
+			}
+		}
+		return nullptr;
+	};
+	for (size_t i = 0; i < level.entries.size(); ++i) {
+		const ObjectConfig &objConfig = level.config.objects[i];
+		for (const auto &portal: level.entries[i].portals) {
+			std::shared_ptr<Portal> target;
+			for (int p = 0; p < objConfig.portalCount; ++p) {
+				const PortalLink &link = objConfig.portals[p];
+				if (link.door == portal->doorNumber) {
+					target = findDoor(link.targetObject, link.targetDoor);
+				}
+			}
+			if (!target) {
+				if (portal->front.toPortal || portal->back.toPortal) {
+					portal->Disconnect();
+				}
+			} else if (portal->front.toPortal != target.get() || portal->back.toPortal != target.get()) {
+				Portal::Connect(portal, target);
+			}
 		}
 	}
-	std::cout << "Caricamento completato. Oggetti totali: " << objs.size() << "\n";
-}
\ No newline at end of file
+}
@@ -2,6 +2,10 @@
 #include "rendering/Mesh.h"
 #include "rendering/Shader.h"
 #include "rendering/Texture.h"
+#include "resources/Resources.h"
+#include <algorithm>
+#include <cstring>
+#include <type_traits>
 
 Object::Object() : pos(0.0f),
                    euler(0.0f),
@@ -9,6 +13,14 @@ Object::Object() : pos(0.0f),
                    p_scale(1.0f) {
 }
 
+Object::~Object() {
+	SetParent(nullptr);
+	for (Object *child: children) {
+		child->parent = nullptr;
+		child->dirty = true;
+	}
+}
+
 void Object::Reset() {
 	pos.SetZero();
 	euler.SetZero();
@@ -24,27 +36,84 @@ void Object::Draw(const Camera &cam, uint32_t curFBO) {
 		if (texture) {
 			texture->Use();
 		}
+		if (textureLayer >= 0) {
+			shader->SetInt(UniformId("layer"), textureLayer);
+		}
 		shader->SetMVP(mvp.m, mv.m);
 		mesh->Draw();
 	}
 }
 
 Vector3 Object::Forward() const {
+	if (parent) {
+		return -LocalToWorld().ZAxis().Normalized();
+	}
 	return -(Matrix4::RotZ(euler.z) * Matrix4::RotX(euler.x) * Matrix4::RotY(euler.y)).ZAxis();
 }
 
-Matrix4 Object::LocalToWorld() const {
-	return Matrix4::Trans(pos) * Matrix4::RotY(euler.y) * Matrix4::RotX(euler.x) * Matrix4::RotZ(euler.z) *
-	       Matrix4::Scale(scale * p_scale);
+void Object::SetParent(Object *newParent) {
+	if (newParent == parent) {
+		return;
+	}
+	if (parent) {
+		auto &siblings = parent->children;
+		siblings.erase(std::find(siblings.begin(), siblings.end(), this));
+	}
+	parent = newParent;
+	if (parent) {
+		parent->children.push_back(this);
+	}
+	dirty = true;
 }
 
-Matrix4 Object::WorldToLocal() const {
-	return Matrix4::Scale(1.0f / (scale * p_scale)) * Matrix4::RotZ(-euler.z) * Matrix4::RotX(-euler.x) *
-	       Matrix4::RotY(-euler.y) * Matrix4::Trans(-pos);
+const Matrix4 &Object::LocalToWorld() const {
+	UpdateWorld();
+	return world;
+}
+
+const Matrix4 &Object::WorldToLocal() const {
+	UpdateWorld();
+	return worldInv;
+}
+
+uint32_t Object::TransformVersion() const {
+	UpdateWorld();
+	return version;
+}
+
+void Object::UpdateWorld() const {
+	// Pull the ancestors first, a rebuilt parent flags its children dirty
+	if (parent) {
+		parent->UpdateWorld();
+	}
+
+	// pos and friends are public and written directly, so changes are found by comparison
+	static_assert(std::is_trivially_copyable_v<LocalPose>);
+	const LocalPose cur{pos, euler, scale, p_scale};
+	if (!dirty && std::memcmp(&cur, &pose, sizeof(LocalPose)) == 0) {
+		return;
+	}
+
+	world = Matrix4::Trans(pos) * Matrix4::RotY(euler.y) * Matrix4::RotX(euler.x) * Matrix4::RotZ(euler.z) *
+	        Matrix4::Scale(scale * p_scale);
+	worldInv = Matrix4::Scale(1.0f / (scale * p_scale)) * Matrix4::RotZ(-euler.z) * Matrix4::RotX(-euler.x) *
+	           Matrix4::RotY(-euler.y) * Matrix4::Trans(-pos);
+	if (parent) {
+		world = parent->world * world;
+		worldInv = worldInv * parent->worldInv;
+	}
+	pose = cur;
+	dirty = false;
+	++version;
+
+	// Only the subtree below a change is rebuilt
+	for (Object *child: children) {
+		child->dirty = true;
+	}
 }
 
-void Object::DebugDraw(const Camera &cam) const {
+void Object::DebugDraw(DebugLines &lines) const {
 	if (mesh) {
-		mesh->DebugDraw(cam, LocalToWorld());
+		mesh->DebugDraw(lines, LocalToWorld());
 	}
 }
@@ -1,12 +1,16 @@
 #include "game/objects/interactive/Portal.h"
 #include "core/engine/Engine.h"
+#include "rendering/LayeredFrameBuffer.h"
+#include "rendering/ViewSet.h"
 #include <cassert>
 #include <iostream>
 
 Portal::Portal() : front(this), back(this) {
-	mesh = AcquireMesh("double_quad.obj");
-	shader = AcquireShader("portal");
-	errShader = AcquireShader("pink");
+	// Interned once, every tunnel builds two portals
+	static const Atom MESH("double_quad.obj"), SHADER("portal"), ERR_SHADER("pink");
+	mesh = AcquireMesh(MESH);
+	shader = AcquireShader(SHADER);
+	errShader = AcquireShader(ERR_SHADER);
 }
 
 void Portal::Draw(const Camera &cam, GLuint curFBO) {
@@ -19,10 +23,45 @@ void Portal::Draw(const Camera &cam, GLuint curFBO) {
 		return;
 	}
 
+	//Create new portal camera
+	Camera portalCam;
+	const Portal *toPortal = ViewCamera(cam, portalCam);
+
+	//Render portal's view from new camera, nested portals use the buffers of lower depths
+	const FrameBuffer &frameBuf = GH_ENGINE->PortalBuffer(GH_REC_LEVEL);
+	frameBuf.Render(portalCam, curFBO, toPortal);
+	cam.UseViewport();
+
+	//Now we can render the portal texture to the screen
+	const Matrix4 mv = LocalToWorld();
+	const Matrix4 mvp = cam.Matrix() * mv;
+	shader->Use();
+	frameBuf.Use();
+	shader->SetMVP(mvp.m, mv.m);
+	mesh->Draw();
+}
+
+void Portal::DrawPortalViews(const ViewSet &views, const int *srcLayers, const LayeredFrameBuffer *src) {
+	assert(views.Count() <= GH_MULTIVIEW_MAX_VIEWS);
+	if (!mvShader) {
+		mvShader = AcquireShader("portal_mv");
+	}
+	mvShader->Use();
+	if (src) {
+		src->Use();
+	}
+	views.Bind(*mvShader);
+	mvShader->SetMat4(UniformId("model"), LocalToWorld().m);
+	mvShader->SetIntArray(UniformId("srcLayer"), srcLayers, views.Count());
+	mesh->DrawInstanced(views.Count());
+}
+
+const Portal *Portal::ViewCamera(const Camera &cam, Camera &portalCam) const {
 	//Find normal relative to camera
 	Vector3 normal = Forward();
 	const Vector3 camPos = cam.worldView.Inverse().Translation();
-	const bool frontDirection = (camPos - pos).Dot(normal) > 0;
+	const Vector3 center = LocalToWorld().Translation();
+	const bool frontDirection = (camPos - center).Dot(normal) > 0;
 	const Warp *warp = (frontDirection ? &front : &back);
 	if (frontDirection) {
 		normal = -normal;
@@ -31,24 +70,33 @@ void Portal::Draw(const Camera &cam, GLuint curFBO) {
 	//Extra clipping to prevent artifacts
 	const float extra_clip = GH_MIN(GH_ENGINE->NearestPortalDist() * 0.5f, 0.1f);
 
-	//Create new portal camera
-	Camera portalCam = cam;
-	portalCam.ClipOblique(pos - normal * extra_clip, -normal);
+	portalCam = cam;
+	portalCam.ClipOblique(center - normal * extra_clip, -normal);
 	portalCam.worldView *= warp->delta;
 	portalCam.width = GH_FBO_SIZE;
 	portalCam.height = GH_FBO_SIZE;
+	return warp->toPortal;
+}
 
-	//Render portal's view from new camera
-	frameBuf[GH_REC_LEVEL - 1].Render(portalCam, curFBO, warp->toPortal);
-	cam.UseViewport();
-
-	//Now we can render the portal texture to the screen
-	const Matrix4 mv = LocalToWorld();
-	const Matrix4 mvp = cam.Matrix() * mv;
-	shader->Use();
-	frameBuf[GH_REC_LEVEL - 1].Use();
-	shader->SetMVP(mvp.m, mv.m);
-	mesh->Draw();
+bool Portal::InFrustum(const Camera &cam) const {
+	//The portal is outside if all corners lie beyond the same clip plane
+	const Matrix4 mvp = cam.Matrix() * LocalToWorld();
+	int outside[6] = {};
+	for (int i = 0; i < 4; ++i) {
+		const Vector4 c = mvp * Vector4((i & 1) ? 1.0f : -1.0f, (i & 2) ? 1.0f : -1.0f, 0.0f, 1.0f);
+		outside[0] += (c.x < -c.w);
+		outside[1] += (c.x > c.w);
+		outside[2] += (c.y < -c.w);
+		outside[3] += (c.y > c.w);
+		outside[4] += (c.z < -c.w);
+		outside[5] += (c.z > c.w);
+	}
+	for (const int n: outside) {
+		if (n == 4) {
+			return false;
+		}
+	}
+	return true;
 }
 
 void Portal::DrawPink(const Camera &cam) const {
@@ -61,18 +109,18 @@ void Portal::DrawPink(const Camera &cam) const {
 
 Vector3 Portal::GetBump(const Vector3 &a) const {
 	const Vector3 n = Forward();
-	return n * ((a - pos).Dot(n) > 0 ? 1.0f : -1.0f);
+	return n * ((a - LocalToWorld().Translation()).Dot(n) > 0 ? 1.0f : -1.0f);
 }
 
 const Portal::Warp *Portal::Intersects(const Vector3 &a, const Vector3 &b, const Vector3 &bump) const {
 	const Vector3 n = Forward();
-	const Vector3 p = pos + bump;
+	const Matrix4 &m = LocalToWorld();
+	const Vector3 p = m.Translation() + bump;
 	const float da = n.Dot(a - p);
 	const float db = n.Dot(b - p);
 	if (da * db > 0.0f) {
 		return nullptr;
 	}
-	const Matrix4 m = LocalToWorld();
 	const Vector3 d = a + (b - a) * (da / (da - db)) - p;
 	const Vector3 x = (m * Vector4(1, 0, 0, 0)).XYZ();
 	if (std::abs(d.Dot(x)) >= x.Dot(x)) {
@@ -87,7 +135,7 @@ const Portal::Warp *Portal::Intersects(const Vector3 &a, const Vector3 &b, const
 
 float Portal::DistTo(const Vector3 &pt) const {
 	//Get world delta
-	const Matrix4 localToWorld = LocalToWorld();
+	const Matrix4 &localToWorld = LocalToWorld();
 	const Vector3 v = pt - localToWorld.Translation();
 
 	//Get axes
@@ -111,8 +159,32 @@ void Portal::Connect(const std::shared_ptr<Portal> &a, const std::shared_ptr<Por
 void Portal::Connect(Warp &a, Warp &b) {
 	a.toPortal = b.fromPortal;
 	b.toPortal = a.fromPortal;
-	a.delta = a.fromPortal->LocalToWorld() * b.fromPortal->WorldToLocal();
-	b.delta = b.fromPortal->LocalToWorld() * a.fromPortal->WorldToLocal();
-	a.deltaInv = b.delta;
-	b.deltaInv = a.delta;
+	a.Bake();
+	b.Bake();
+}
+
+void Portal::Disconnect() {
+	for (Warp *warp: {&front, &back}) {
+		warp->toPortal = nullptr;
+		warp->delta.MakeIdentity();
+		warp->deltaInv.MakeIdentity();
+	}
+}
+
+void Portal::RefreshWarps() {
+	front.Refresh();
+	back.Refresh();
+}
+
+void Portal::Warp::Bake() {
+	delta = fromPortal->LocalToWorld() * toPortal->WorldToLocal();
+	deltaInv = toPortal->LocalToWorld() * fromPortal->WorldToLocal();
+	fromVersion = fromPortal->TransformVersion();
+	toVersion = toPortal->TransformVersion();
+}
+
+void Portal::Warp::Refresh() {
+	if (toPortal && (fromPortal->TransformVersion() != fromVersion || toPortal->TransformVersion() != toVersion)) {
+		Bake();
+	}
 }
@@ -0,0 +1,24 @@
+#include "game/objects/props/Prop.h"
+#include "core/engine/GameHeader.h"
+#include "resources/Resources.h"
+
+Prop::Prop(Type type) : type(type) {
+	Prop::Reset();
+	static const Atom MESH("prop.obj"), SHADER("texture"), TEXTURE("tunnel.bmp");
+	mesh = AcquireMesh(MESH);
+	shader = AcquireShader(SHADER);
+	texture = AcquireTexture(TEXTURE);
+	hitSpheres.emplace_back(Vector3(0, 0, 0), 1.0f);
+}
+
+void Prop::Reset() {
+	Physical::Reset();
+	if (type == BALL) {
+		bounce = GH_PROP_BALL_BOUNCE;
+		friction = GH_PROP_BALL_FRICTION;
+	} else {
+		bounce = GH_PROP_CRATE_BOUNCE;
+		friction = GH_PROP_CRATE_FRICTION;
+	}
+	drag = GH_PROP_DRAG;
+}
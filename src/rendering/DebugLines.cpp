@@ -0,0 +1,81 @@
+#include "rendering/DebugLines.h"
+#include "rendering/GLState.h"
+#include "rendering/Shader.h"
+#include "resources/Resources.h"
+#include <cstddef>
+
+static constexpr size_t INITIAL_CAPACITY = 1024;
+
+DebugLines::DebugLines() {
+	shader = AcquireShader("debug");
+
+	glGenVertexArrays(1, &vao);
+	glGenBuffers(1, &vbo);
+
+	GLState::BindVertexArray(vao);
+	GLState::BindBuffer(GL_ARRAY_BUFFER, vbo);
+
+	// Define vertex attribute layout
+	glEnableVertexAttribArray(0);  // position
+	glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, sizeof(Vertex), reinterpret_cast<void *>(offsetof(Vertex, pos)));
+	glEnableVertexAttribArray(1);  // color
+	glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, sizeof(Vertex), reinterpret_cast<void *>(offsetof(Vertex, color)));
+
+	capacity = INITIAL_CAPACITY;
+	glBufferData(GL_ARRAY_BUFFER, static_cast<GLsizeiptr>(capacity * sizeof(Vertex)), nullptr, GL_STREAM_DRAW);
+	vertices.reserve(capacity);
+}
+
+DebugLines::~DebugLines() {
+	GLState::OnDeleteBuffer(vbo);
+	GLState::OnDeleteVertexArray(vao);
+	glDeleteBuffers(1, &vbo);
+	glDeleteVertexArrays(1, &vao);
+}
+
+void DebugLines::AddLine(const Vector3 &a, const Vector3 &b, const Vector3 &color) {
+	vertices.push_back({{a.x, a.y, a.z}, {color.x, color.y, color.z}});
+	vertices.push_back({{b.x, b.y, b.z}, {color.x, color.y, color.z}});
+}
+
+void DebugLines::AddQuad(const Matrix4 &mat, const Vector3 &color) {
+	const Vector3 corners[4] = {
+			mat.MulPoint(Vector3(1, 1, 0)),
+			mat.MulPoint(Vector3(1, -1, 0)),
+			mat.MulPoint(Vector3(-1, -1, 0)),
+			mat.MulPoint(Vector3(-1, 1, 0))
+	};
+	for (int i = 0; i < 4; ++i) {
+		AddLine(corners[i], corners[(i + 1) % 4], color);
+	}
+}
+
+void DebugLines::Flush(const Camera &cam) {
+	if (vertices.empty()) {
+		return;
+	}
+
+	GLState::BindVertexArray(vao);
+	GLState::BindBuffer(GL_ARRAY_BUFFER, vbo);
+
+	// Grow geometrically, otherwise orphan the old storage so the driver never stalls on it
+	if (vertices.size() > capacity) {
+		while (capacity < vertices.size()) {
+			capacity *= 2;
+		}
+	}
+	const auto bytes = static_cast<GLsizeiptr>(vertices.size() * sizeof(Vertex));
+	glBufferData(GL_ARRAY_BUFFER, static_cast<GLsizeiptr>(capacity * sizeof(Vertex)), nullptr, GL_STREAM_DRAW);
+	glBufferSubData(GL_ARRAY_BUFFER, 0, bytes, vertices.data());
+
+	const Matrix4 mvp = cam.Matrix();
+	shader->Use();
+	shader->SetMVP(mvp.m, nullptr);
+
+	// Debug lines are always visible
+	GLState::DepthFunc(GL_ALWAYS);
+	glDrawArrays(GL_LINES, 0, static_cast<GLsizei>(vertices.size()));
+	GLState::DepthFunc(GL_LESS);
+
+	vertices.clear();
+}
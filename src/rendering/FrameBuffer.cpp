@@ -1,4 +1,5 @@
 #include "rendering/FrameBuffer.h"
+#include "rendering/GLState.h"
 #include "core/engine/GameHeader.h"
 #include "core/engine/Engine.h"
 #include <iostream>
@@ -12,9 +13,9 @@ bool FrameBuffer::CheckFramebufferStatus(GLuint framebuffer) {
 	if (HasDSASupport()) {
 		status = glCheckNamedFramebufferStatus(framebuffer, GL_FRAMEBUFFER);
 	} else {
-		glBindFramebufferEXT(GL_FRAMEBUFFER_EXT, framebuffer);
+		GLState::BindFramebuffer(framebuffer);
 		status = glCheckFramebufferStatusEXT(GL_FRAMEBUFFER_EXT);
-		glBindFramebufferEXT(GL_FRAMEBUFFER_EXT, 0);
+		GLState::BindFramebuffer(0);
 	}
 	return status == GL_FRAMEBUFFER_COMPLETE;
 }
@@ -40,7 +41,7 @@ FrameBuffer::FrameBuffer() {
 	} else {
 		// Legacy path (existing code)
 		glGenTextures(1, &texId);
-		glBindTexture(GL_TEXTURE_2D, texId);
+		GLState::BindTexture(GL_TEXTURE_2D, texId);
 		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP);
 		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP);
 		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
@@ -48,7 +49,7 @@ FrameBuffer::FrameBuffer() {
 		glTexImage2D(GL_TEXTURE_2D, 0, GL_RGB, GH_FBO_SIZE, GH_FBO_SIZE, 0, GL_RGB, GL_UNSIGNED_BYTE, nullptr);
 
 		glGenFramebuffersEXT(1, &fbo);
-		glBindFramebufferEXT(GL_FRAMEBUFFER_EXT, fbo);
+		GLState::BindFramebuffer(fbo);
 		glFramebufferTexture2DEXT(GL_FRAMEBUFFER_EXT, GL_COLOR_ATTACHMENT0_EXT, GL_TEXTURE_2D, texId, 0);
 
 		glGenRenderbuffersEXT(1, &renderBuf);
@@ -61,9 +62,14 @@ FrameBuffer::FrameBuffer() {
 		std::cerr << "Framebuffer is not complete!" << std::endl;
 		// Handle error appropriately
 	}
+
+	// RGB8 color and 16-bit depth
+	memory.Set(0, static_cast<size_t>(GH_FBO_SIZE) * GH_FBO_SIZE * (3 + 2));
 }
 
 FrameBuffer::~FrameBuffer() {
+	GLState::OnDeleteTexture(texId);
+	GLState::OnDeleteFramebuffer(fbo);
 	if (HasDSASupport()) {
 		glDeleteTextures(1, &texId);
 		glDeleteFramebuffers(1, &fbo);
@@ -76,22 +82,12 @@ FrameBuffer::~FrameBuffer() {
 }
 
 void FrameBuffer::Use() const {
-	glBindTexture(GL_TEXTURE_2D, texId);
+	GLState::BindTexture(GL_TEXTURE_2D, texId);
 }
 
 void FrameBuffer::Render(const Camera &cam, GLuint curFBO, const Portal *skipPortal) const {
-	if (HasDSASupport()) {
-		glBindFramebuffer(GL_FRAMEBUFFER, fbo);
-	} else {
-		glBindFramebufferEXT(GL_FRAMEBUFFER_EXT, fbo);
-	}
-
-	glViewport(0, 0, GH_FBO_SIZE, GH_FBO_SIZE);
+	GLState::BindFramebuffer(fbo);
+	GLState::Viewport(0, 0, GH_FBO_SIZE, GH_FBO_SIZE);
 	GH_ENGINE->Render(cam, fbo, skipPortal);
-
-	if (HasDSASupport()) {
-		glBindFramebuffer(GL_FRAMEBUFFER, curFBO);
-	} else {
-		glBindFramebufferEXT(GL_FRAMEBUFFER_EXT, curFBO);
-	}
+	GLState::BindFramebuffer(curFBO);
 }
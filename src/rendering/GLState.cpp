@@ -0,0 +1,228 @@
+#include "rendering/GLState.h"
+#include <cassert>
+#include <iostream>
+
+namespace {
+	constexpr GLuint UNKNOWN = ~0u;
+
+	const char *const CALL_NAMES[GLState::NUM_CALLS] = {
+			"UseProgram",
+			"BindTexture",
+			"BindVertexArray",
+			"BindBuffer",
+			"BindFramebuffer",
+			"Viewport",
+			"DepthMask",
+			"DepthFunc",
+			"ColorMask"
+	};
+
+	// Tracked texture targets, other targets are passed through
+	int TargetIndex(GLenum target) {
+		switch (target) {
+			case GL_TEXTURE_2D:
+				return 0;
+			case GL_TEXTURE_2D_ARRAY:
+				return 1;
+			default:
+				return -1;
+		}
+	}
+
+	// Tracked buffer targets, the element array binding belongs to the VAO
+	int BufferIndex(GLenum target) {
+		switch (target) {
+			case GL_ARRAY_BUFFER:
+				return 0;
+			case GL_PIXEL_UNPACK_BUFFER:
+				return 1;
+			default:
+				return -1;
+		}
+	}
+
+	struct CachedState {
+		GLuint program = UNKNOWN;
+		GLuint activeUnit = UNKNOWN;
+		GLuint textures[GLState::MAX_TEXTURE_UNITS][2];
+		GLuint vao = UNKNOWN;
+		GLuint buffers[2] = {UNKNOWN, UNKNOWN};
+		GLuint fbo = UNKNOWN;
+		GLint viewport[4] = {-1, -1, -1, -1};
+		GLuint depthMask = UNKNOWN;
+		GLuint depthFunc = UNKNOWN;
+		GLuint colorMask = UNKNOWN;
+
+		CachedState() {
+			for (auto &unit: textures) {
+				unit[0] = UNKNOWN;
+				unit[1] = UNKNOWN;
+			}
+		}
+	};
+
+	CachedState state;
+}
+
+GLState::Stats GLState::curFrame{};
+GLState::Stats GLState::lastFrame{};
+
+uint32_t GLState::Stats::TotalIssued() const {
+	uint32_t total = 0;
+	for (const uint32_t n: issued) {
+		total += n;
+	}
+	return total;
+}
+
+uint32_t GLState::Stats::TotalSkipped() const {
+	uint32_t total = 0;
+	for (const uint32_t n: skipped) {
+		total += n;
+	}
+	return total;
+}
+
+bool GLState::Track(Call call, bool changed) {
+	if (changed) {
+		curFrame.issued[call] += 1;
+	} else {
+		curFrame.skipped[call] += 1;
+	}
+	return changed;
+}
+
+void GLState::UseProgram(GLuint program) {
+	if (Track(PROGRAM, state.program != program)) {
+		glUseProgram(program);
+		state.program = program;
+	}
+}
+
+void GLState::BindTexture(GLenum target, GLuint texture, unsigned int unit) {
+	assert(unit < MAX_TEXTURE_UNITS);
+	const int index = TargetIndex(target);
+	if (index >= 0 && state.textures[unit][index] == texture) {
+		Track(TEXTURE, false);
+		return;
+	}
+	if (state.activeUnit != unit) {
+		glActiveTexture(GL_TEXTURE0 + unit);
+		state.activeUnit = unit;
+	}
+	Track(TEXTURE, true);
+	glBindTexture(target, texture);
+	if (index >= 0) {
+		state.textures[unit][index] = texture;
+	}
+}
+
+void GLState::BindVertexArray(GLuint vao) {
+	if (Track(VERTEX_ARRAY, state.vao != vao)) {
+		glBindVertexArray(vao);
+		state.vao = vao;
+	}
+}
+
+void GLState::BindBuffer(GLenum target, GLuint buffer) {
+	const int index = BufferIndex(target);
+	if (Track(BUFFER, index < 0 || state.buffers[index] != buffer)) {
+		glBindBuffer(target, buffer);
+		if (index >= 0) {
+			state.buffers[index] = buffer;
+		}
+	}
+}
+
+void GLState::BindFramebuffer(GLuint fbo) {
+	if (Track(FRAMEBUFFER, state.fbo != fbo)) {
+		glBindFramebuffer(GL_FRAMEBUFFER, fbo);
+		state.fbo = fbo;
+	}
+}
+
+void GLState::Viewport(GLint x, GLint y, GLsizei width, GLsizei height) {
+	GLint *vp = state.viewport;
+	if (Track(VIEWPORT, vp[0] != x || vp[1] != y || vp[2] != width || vp[3] != height)) {
+		glViewport(x, y, width, height);
+		vp[0] = x;
+		vp[1] = y;
+		vp[2] = width;
+		vp[3] = height;
+	}
+}
+
+void GLState::DepthMask(GLboolean flag) {
+	if (Track(DEPTH_MASK, state.depthMask != flag)) {
+		glDepthMask(flag);
+		state.depthMask = flag;
+	}
+}
+
+void GLState::DepthFunc(GLenum func) {
+	if (Track(DEPTH_FUNC, state.depthFunc != func)) {
+		glDepthFunc(func);
+		state.depthFunc = func;
+	}
+}
+
+void GLState::ColorMask(GLboolean r, GLboolean g, GLboolean b, GLboolean a) {
+	const GLuint mask = (r ? 1u : 0u) | (g ? 2u : 0u) | (b ? 4u : 0u) | (a ? 8u : 0u);
+	if (Track(COLOR_MASK, state.colorMask != mask)) {
+		glColorMask(r, g, b, a);
+		state.colorMask = mask;
+	}
+}
+
+void GLState::OnDeleteProgram(GLuint program) {
+	if (state.program == program) {
+		state.program = UNKNOWN;
+	}
+}
+
+void GLState::OnDeleteTexture(GLuint texture) {
+	for (auto &unit: state.textures) {
+		for (GLuint &bound: unit) {
+			if (bound == texture) {
+				bound = UNKNOWN;
+			}
+		}
+	}
+}
+
+void GLState::OnDeleteVertexArray(GLuint vao) {
+	if (state.vao == vao) {
+		state.vao = UNKNOWN;
+	}
+}
+
+void GLState::OnDeleteBuffer(GLuint buffer) {
+	for (GLuint &bound: state.buffers) {
+		if (bound == buffer) {
+			bound = UNKNOWN;
+		}
+	}
+}
+
+void GLState::OnDeleteFramebuffer(GLuint fbo) {
+	if (state.fbo == fbo) {
+		state.fbo = UNKNOWN;
+	}
+}
+
+void GLState::Invalidate() {
+	state = CachedState();
+}
+
+void GLState::BeginFrame() {
+	lastFrame = curFrame;
+	curFrame = Stats{};
+}
+
+void GLState::PrintStats() {
+	std::cout << "GL state calls last frame (issued / skipped):\n";
+	for (int i = 0; i < NUM_CALLS; ++i) {
+		std::cout << "  " << CALL_NAMES[i] << ": " << lastFrame.issued[i] << " / " << lastFrame.skipped[i] << "\n";
+	}
+	std::cout << "  Total: " << lastFrame.TotalIssued() << " / " << lastFrame.TotalSkipped() << "\n";
+}
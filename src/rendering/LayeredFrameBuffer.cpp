@@ -0,0 +1,69 @@
+#include "rendering/LayeredFrameBuffer.h"
+#include "rendering/GLState.h"
+#include "core/engine/GameHeader.h"
+#include <iostream>
+
+LayeredFrameBuffer::~LayeredFrameBuffer() {
+	Destroy();
+}
+
+void LayeredFrameBuffer::Destroy() {
+	if (fbo) {
+		GLState::OnDeleteFramebuffer(fbo);
+		GLState::OnDeleteTexture(texId);
+		GLState::OnDeleteTexture(depthId);
+		glDeleteFramebuffers(1, &fbo);
+		glDeleteTextures(1, &texId);
+		glDeleteTextures(1, &depthId);
+	}
+	fbo = 0;
+	texId = 0;
+	depthId = 0;
+	layers = 0;
+	memory.Set(0, 0);
+}
+
+void LayeredFrameBuffer::Reserve(int numLayers) {
+	if (numLayers <= layers) {
+		return;
+	}
+
+	// Storage is immutable in size, grow by recreating it
+	Destroy();
+	layers = numLayers;
+
+	glGenTextures(1, &texId);
+	GLState::BindTexture(GL_TEXTURE_2D_ARRAY, texId);
+	glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+	glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+	glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+	glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+	glTexImage3D(GL_TEXTURE_2D_ARRAY, 0, GL_RGB8, GH_FBO_SIZE, GH_FBO_SIZE, layers, 0, GL_RGB, GL_UNSIGNED_BYTE,
+	             nullptr);
+
+	// Renderbuffers cannot be layered, so depth is an array texture as well
+	glGenTextures(1, &depthId);
+	GLState::BindTexture(GL_TEXTURE_2D_ARRAY, depthId);
+	glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+	glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+	glTexImage3D(GL_TEXTURE_2D_ARRAY, 0, GL_DEPTH_COMPONENT16, GH_FBO_SIZE, GH_FBO_SIZE, layers, 0,
+	             GL_DEPTH_COMPONENT, GL_UNSIGNED_SHORT, nullptr);
+
+	glGenFramebuffers(1, &fbo);
+	GLState::BindFramebuffer(fbo);
+	glFramebufferTexture(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, texId, 0);
+	glFramebufferTexture(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, depthId, 0);
+	if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE) {
+		std::cerr << "Layered framebuffer is not complete!" << std::endl;
+	}
+	memory.Set(0, static_cast<size_t>(GH_FBO_SIZE) * GH_FBO_SIZE * layers * (3 + 2));
+}
+
+void LayeredFrameBuffer::Bind() const {
+	GLState::BindFramebuffer(fbo);
+	GLState::Viewport(0, 0, GH_FBO_SIZE, GH_FBO_SIZE);
+}
+
+void LayeredFrameBuffer::Use(unsigned int slot) const {
+	GLState::BindTexture(GL_TEXTURE_2D_ARRAY, texId, slot);
+}
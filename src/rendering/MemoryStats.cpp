@@ -0,0 +1,60 @@
+#include "rendering/MemoryStats.h"
+#include <iostream>
+
+namespace {
+	const char *const CLASS_NAMES[MemoryStats::NUM_CLASSES] = {"Meshes", "Textures", "Framebuffers", "Shaders"};
+
+	size_t KiB(size_t bytes) {
+		return (bytes + 1023) / 1024;
+	}
+}
+
+MemoryStats::Usage MemoryStats::usage[NUM_CLASSES];
+
+MemoryStats::Usage MemoryStats::Total() {
+	Usage total;
+	for (const Usage &u: usage) {
+		total.cpu += u.cpu;
+		total.gpu += u.gpu;
+		total.count += u.count;
+	}
+	return total;
+}
+
+void MemoryStats::Print(const std::string &title, const Usage *level) {
+	const auto print = [](const char *name, const Usage &u, const Usage *own) {
+		std::cout << "  " << name << ": " << u.count << ", " << KiB(u.cpu) << ", " << KiB(u.gpu);
+		if (own) {
+			std::cout << " | " << own->count << ", " << KiB(own->cpu) << ", " << KiB(own->gpu);
+		}
+		std::cout << "\n";
+	};
+	std::cout << title << " (count, CPU KiB, GPU KiB" << (level ? "; process | level" : "") << "):\n";
+	Usage levelTotal;
+	for (int i = 0; i < NUM_CLASSES; ++i) {
+		print(CLASS_NAMES[i], usage[i], level ? &level[i] : nullptr);
+		if (level) {
+			levelTotal.cpu += level[i].cpu;
+			levelTotal.gpu += level[i].gpu;
+			levelTotal.count += level[i].count;
+		}
+	}
+	print("Total", Total(), level ? &levelTotal : nullptr);
+}
+
+MemoryCharge::MemoryCharge(MemoryStats::Class type) : type(type) {
+	MemoryStats::usage[type].count += 1;
+}
+
+MemoryCharge::~MemoryCharge() {
+	Set(0, 0);
+	MemoryStats::usage[type].count -= 1;
+}
+
+void MemoryCharge::Set(size_t newCpu, size_t newGpu) {
+	MemoryStats::Usage &u = MemoryStats::usage[type];
+	u.cpu = u.cpu - cpu + newCpu;
+	u.gpu = u.gpu - gpu + newGpu;
+	cpu = newCpu;
+	gpu = newGpu;
+}
@@ -1,38 +1,37 @@
 #include "rendering/Shader.h"
+#include "rendering/GLState.h"
+#include "rendering/ShaderCache.h"
+#include "core/engine/GameHeader.h"
+#include <algorithm>
+#include <cassert>
+#include <cstring>
 #include <fstream>
 #include <iostream>
 #include <sstream>
 #include <filesystem>
 #include <chrono>
-#include <unordered_map>
 
-// File timestamp cache for hot-reloading
-struct ShaderFileInfo {
-	std::filesystem::file_time_type lastModified;
-	std::string path;
-};
-
-static std::unordered_map<std::string, ShaderFileInfo> vertexShaderFiles;
-static std::unordered_map<std::string, ShaderFileInfo> fragmentShaderFiles;
-
-Shader::Shader(const char *name) : vertId(0), fragId(0), progId(0),
-                                   mvpId(-1), mvId(-1), name(name) {
+Shader::Shader(const char *name) : vertId(0), fragId(0), progId(0), name(name) {
 	LoadShaders();
 }
 
 Shader::~Shader() {
+	GLState::OnDeleteProgram(progId);
 	glDeleteProgram(progId);
 	glDeleteShader(vertId);
 	glDeleteShader(fragId);
 }
 
 bool Shader::LoadShaders() {
+	const auto startTime = std::chrono::steady_clock::now();
+
 	// Delete old shader program and objects
 	if (progId) {
 		// Make sure the shader is not in use before deletion
-		glUseProgram(0);
+		GLState::UseProgram(0);
 
 		// Delete existing objects
+		GLState::OnDeleteProgram(progId);
 		glDeleteProgram(progId);
 		glDeleteShader(vertId);
 		glDeleteShader(fragId);
@@ -42,15 +41,11 @@ bool Shader::LoadShaders() {
 		vertId = 0;
 		fragId = 0;
 
-		// Reset uniform locations
-		mvpId = -1;
-		mvId = -1;
+		// Reset uniform table
+		uniforms.clear();
+		memory.Set(0, 0);
 	}
 
-	// Force GPU pipeline flush
-	glFlush();
-	glFinish();
-
 	// Get file paths
 	std::string vertPath = "assets/shaders/" + std::string(name) + ".vert";
 	std::string fragPath = "assets/shaders/" + std::string(name) + ".frag";
@@ -59,164 +54,95 @@ bool Shader::LoadShaders() {
 
 	std::cout << "Checking shader files for: " << name << std::endl;
 
-	// Store file info for hot-reloading
-	try {
-		if (std::filesystem::exists(vertPath)) {
-			vertexShaderFiles[name] = {std::filesystem::last_write_time(vertPath), vertPath};
-			std::cout << "Found vertex shader: " << vertPath << std::endl;
-		} else if (std::filesystem::exists(spirvVertPath)) {
-			vertexShaderFiles[name] = {std::filesystem::last_write_time(spirvVertPath), spirvVertPath};
-			std::cout << "Found SPIR-V vertex shader: " << spirvVertPath << std::endl;
-		}
-
-		if (std::filesystem::exists(fragPath)) {
-			fragmentShaderFiles[name] = {std::filesystem::last_write_time(fragPath), fragPath};
-			std::cout << "Found fragment shader: " << fragPath << std::endl;
-		} else if (std::filesystem::exists(spirvFragPath)) {
-			// FIX: usa spirvFragPath invece di fragPath
-			fragmentShaderFiles[name] = {std::filesystem::last_write_time(spirvFragPath), spirvFragPath};
-			std::cout << "Found SPIR-V fragment shader: " << spirvFragPath << std::endl;
-		}
-	} catch (const std::filesystem::filesystem_error& e) {
-		std::cerr << "Filesystem error: " << e.what() << "\n";
-	}
-
 	// Try SPIR-V first, then fallback to GLSL
 	bool useSpirV = std::filesystem::exists(spirvVertPath) && std::filesystem::exists(spirvFragPath);
+	const std::string &vertFile = useSpirV ? spirvVertPath : vertPath;
+	const std::string &fragFile = useSpirV ? spirvFragPath : fragPath;
 
-	if (useSpirV) {
-		vertId = LoadSPIRVShader(spirvVertPath.c_str(), GL_VERTEX_SHADER);
-		fragId = LoadSPIRVShader(spirvFragPath.c_str(), GL_FRAGMENT_SHADER);
-	} else {
-		vertId = LoadGLSLShader(vertPath.c_str(), GL_VERTEX_SHADER);
-		fragId = LoadGLSLShader(fragPath.c_str(), GL_FRAGMENT_SHADER);
-	}
-
-	if (!vertId || !fragId) {
+	// Read the sources up front, they are needed both to compile and to key the cache
+	std::string vertSource;
+	std::string fragSource;
+	if (!ReadShaderFile(vertFile.c_str(), vertSource) || !ReadShaderFile(fragFile.c_str(), fragSource)) {
 		std::cerr << "Failed to load shaders: " << name << "\n";
 		return false;
 	}
 
-	// Create program
+	// Try the program binary cache before compiling anything
+	const uint64_t cacheKey = ShaderCache::MakeKey(vertSource, fragSource);
 	progId = glCreateProgram();
-	glAttachShader(progId, vertId);
-	glAttachShader(progId, fragId);
-
-	// Link program
-	glLinkProgram(progId);
-
-	// Check linking errors
-	GLint success;
-	glGetProgramiv(progId, GL_LINK_STATUS, &success);
-	if (!success) {
-		GLchar infoLog[512];
-		glGetProgramInfoLog(progId, 512, nullptr, infoLog);
-		std::cerr << "Shader linking failed (" << name << "):\n" << infoLog << "\n";
-		return false;
-	}
-
-	// Get uniform locations
-	mvpId = glGetUniformLocation(progId, "mvp");
-	mvId = glGetUniformLocation(progId, "mv");
-
-	std::cout << "Shader " << name << " " << (useSpirV ? "[SPIR-V]" : "[GLSL]") << " loaded successfully.\n";
-
-	// After successful loading, force another flush
-	glFlush();
-	glFinish();
-
-	return true;
-}
-
-bool Shader::CheckForUpdates() {
-	bool updated = false;
-
-	// Always recheck the files directly instead of relying only on cached info
-	std::string vertPath = "assets/shaders/" + std::string(name) + ".vert";
-	std::string fragPath = "assets/shaders/" + std::string(name) + ".frag";
-	std::string spirvVertPath = "assets/shaders/" + std::string(name) + ".vert.spv";
-	std::string spirvFragPath = "assets/shaders/" + std::string(name) + ".frag.spv";
-
-	try {
-		// Check all possible shader files for the vertex shader
-		if (std::filesystem::exists(vertPath)) {
-			auto lastMod = std::filesystem::last_write_time(vertPath);
-			auto it = vertexShaderFiles.find(name);
-			if (it != vertexShaderFiles.end() && lastMod > it->second.lastModified) {
-				std::cout << "Vertex shader modified: " << vertPath << std::endl;
-				updated = true;
-				vertexShaderFiles[name].lastModified = lastMod;
-			}
+	const bool fromCache = ShaderCache::Load(progId, name, cacheKey);
+
+	if (!fromCache) {
+		if (useSpirV) {
+			vertId = LoadSPIRVShader(vertSource, vertFile.c_str(), GL_VERTEX_SHADER);
+			fragId = LoadSPIRVShader(fragSource, fragFile.c_str(), GL_FRAGMENT_SHADER);
+		} else {
+			vertId = LoadGLSLShader(vertSource, vertFile.c_str(), GL_VERTEX_SHADER);
+			fragId = LoadGLSLShader(fragSource, fragFile.c_str(), GL_FRAGMENT_SHADER);
 		}
 
-		if (std::filesystem::exists(spirvVertPath)) {
-			auto lastMod = std::filesystem::last_write_time(spirvVertPath);
-			auto it = vertexShaderFiles.find(name);
-			if (it != vertexShaderFiles.end() && lastMod > it->second.lastModified) {
-				std::cout << "SPIR-V vertex shader modified: " << spirvVertPath << std::endl;
-				updated = true;
-				vertexShaderFiles[name].lastModified = lastMod;
-			}
+		if (!vertId || !fragId) {
+			std::cerr << "Failed to load shaders: " << name << "\n";
+			GLState::OnDeleteProgram(progId);
+			glDeleteProgram(progId);
+			progId = 0;
+			return false;
 		}
 
-		// Check all possible shader files for the fragment shader
-		if (std::filesystem::exists(fragPath)) {
-			auto lastMod = std::filesystem::last_write_time(fragPath);
-			auto it = fragmentShaderFiles.find(name);
-			if (it != fragmentShaderFiles.end() && lastMod > it->second.lastModified) {
-				std::cout << "Fragment shader modified: " << fragPath << std::endl;
-				updated = true;
-				fragmentShaderFiles[name].lastModified = lastMod;
-			}
+		// Attach shaders
+		glAttachShader(progId, vertId);
+		glAttachShader(progId, fragId);
+
+		// Link program, asking the driver to keep the binary around for the cache
+		if (ShaderCache::IsSupported()) {
+			glProgramParameteri(progId, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
 		}
+		glLinkProgram(progId);
 
-		if (std::filesystem::exists(spirvFragPath)) {
-			auto lastMod = std::filesystem::last_write_time(spirvFragPath);
-			auto it = fragmentShaderFiles.find(name);
-			if (it != fragmentShaderFiles.end() && lastMod > it->second.lastModified) {
-				std::cout << "SPIR-V fragment shader modified: " << spirvFragPath << std::endl;
-				updated = true;
-				fragmentShaderFiles[name].lastModified = lastMod;
-			}
+		// Check linking errors
+		GLint success;
+		glGetProgramiv(progId, GL_LINK_STATUS, &success);
+		if (!success) {
+			GLchar infoLog[512];
+			glGetProgramInfoLog(progId, 512, nullptr, infoLog);
+			std::cerr << "Shader linking failed (" << name << "):\n" << infoLog << "\n";
+			return false;
 		}
-	} catch (const std::filesystem::filesystem_error& e) {
-		std::cerr << "Filesystem error during shader update check: " << e.what() << "\n";
+
+		ShaderCache::Store(progId, name, cacheKey);
 	}
 
-	// Reload if necessary
-	if (updated) {
-		std::cout << "Shader " << name << " changed, reloading...\n";
-		return LoadShaders();
+	// Build the uniform table
+	ReflectUniforms();
+
+	// The linked binary stands in for what the driver keeps of the program
+	GLint binaryLength = 0;
+	if (ShaderCache::IsSupported()) {
+		glGetProgramiv(progId, GL_PROGRAM_BINARY_LENGTH, &binaryLength);
 	}
+	memory.Set(sizeof(Uniform) * uniforms.capacity(), static_cast<size_t>(binaryLength));
+
+	const std::chrono::duration<float, std::milli> elapsed = std::chrono::steady_clock::now() - startTime;
+	std::cout << "Shader " << name << " " << (useSpirV ? "[SPIR-V]" : "[GLSL]")
+	          << (fromCache ? " [cache]" : "") << " loaded successfully in " << elapsed.count() << " ms.\n";
 
-	return false;
+	return true;
 }
 
-GLuint Shader::LoadGLSLShader(const char *fname, GLenum type) {
-	std::ifstream file(fname);
+bool Shader::ReadShaderFile(const char *fname, std::string &content) {
+	std::ifstream file(fname, std::ios::binary);
 	if (!file.is_open()) {
 		std::cerr << "Failed to open shader file: " << fname << "\n";
-		return 0;
+		return false;
 	}
 
 	std::stringstream buffer;
 	buffer << file.rdbuf();
-	std::string content = buffer.str();
-
-	// Add a timestamp comment to invalidate driver cache
-	auto now = std::chrono::system_clock::now();
-	auto time_t_now = std::chrono::system_clock::to_time_t(now);
-	std::stringstream timestamp;
-	timestamp << "\n// Shader reload timestamp: " << time_t_now << "\n";
-
-	// Find the first line (usually version directive) and insert the timestamp after it
-	size_t pos = content.find('\n');
-	if (pos != std::string::npos) {
-		content.insert(pos + 1, timestamp.str());
-	} else {
-		content = timestamp.str() + content;
-	}
+	content = buffer.str();
+	return true;
+}
 
+GLuint Shader::LoadGLSLShader(const std::string &content, const char *fname, GLenum type) {
 	const char *source = content.c_str();
 
 	GLuint shader = glCreateShader(type);
@@ -229,33 +155,24 @@ GLuint Shader::LoadGLSLShader(const char *fname, GLenum type) {
 		GLchar infoLog[512];
 		glGetShaderInfoLog(shader, 512, nullptr, infoLog);
 		std::cerr << "Shader compilation failed (" << fname << "):\n" << infoLog << "\n";
+		glDeleteShader(shader);
 		return 0;
 	}
 
 	return shader;
 }
 
-GLuint Shader::LoadSPIRVShader(const char *fname, GLenum type) {
-	std::ifstream file(fname, std::ios::binary);
-	if (!file.is_open()) {
-		std::cerr << "Failed to open SPIR-V shader file: " << fname << "\n";
-		return 0;
-	}
-
-	// Get file size
-	file.seekg(0, std::ios::end);
-	size_t fileSize = file.tellg();
-	file.seekg(0, std::ios::beg);
-
+GLuint Shader::LoadSPIRVShader(const std::string &content, const char *fname, GLenum type) {
 	// SPIR-V is a binary format with 4-byte words
+	const size_t fileSize = content.size();
 	if (fileSize % 4 != 0) {
 		std::cerr << "Invalid SPIR-V file: " << fname << " (size not multiple of 4)\n";
 		return 0;
 	}
 
-	// Read the SPIR-V binary
+	// Copy into word storage so the binary is correctly aligned
 	std::vector<uint32_t> spirvData(fileSize / 4);
-	file.read(reinterpret_cast<char*>(spirvData.data()), fileSize);
+	std::memcpy(spirvData.data(), content.data(), fileSize);
 
 	// Create and specify shader
 	GLuint shader = glCreateShader(type);
@@ -290,14 +207,120 @@ GLuint Shader::LoadSPIRVShader(const char *fname, GLenum type) {
 }
 
 void Shader::Use() const {
-	glUseProgram(progId);
+	GLState::UseProgram(progId);
+}
+
+void Shader::SetMVP(const float *mvp, const float *mv) {
+	if (mvp) {
+		SetMat4(UniformId("mvp"), mvp);
+	}
+	if (mv) {
+		SetMat4(UniformId("mv"), mv);
+	}
 }
 
-void Shader::SetMVP(const float *mvp, const float *mv) const {
-	if (mvpId != -1 && mvp) {
-		glUniformMatrix4fv(mvpId, 1, GL_TRUE, mvp);
+void Shader::ReflectUniforms() {
+	uniforms.clear();
+
+	GLint count = 0;
+	GLint maxLength = 0;
+	glGetProgramiv(progId, GL_ACTIVE_UNIFORMS, &count);
+	glGetProgramiv(progId, GL_ACTIVE_UNIFORM_MAX_LENGTH, &maxLength);
+	if (count <= 0) {
+		return;
 	}
-	if (mvId != -1 && mv) {
-		glUniformMatrix4fv(mvId, 1, GL_TRUE, mv);
+
+	std::vector<GLchar> nameBuf(GH_MAX(maxLength, 1));
+	uniforms.reserve(count);
+	for (GLint i = 0; i < count; ++i) {
+		GLsizei length = 0;
+		Uniform uniform{};
+		glGetActiveUniform(progId, static_cast<GLuint>(i), static_cast<GLsizei>(nameBuf.size()), &length,
+		                   &uniform.size, &uniform.type, nameBuf.data());
+
+		std::string_view uniformName(nameBuf.data(), length);
+		uniform.location = glGetUniformLocation(progId, nameBuf.data());
+		if (uniform.location < 0) {
+			continue; // member of a uniform block
+		}
+
+		// Arrays are reported as "name[0]"
+		if (uniformName.ends_with("[0]")) {
+			uniformName.remove_suffix(3);
+		}
+		uniform.id = HashFNV32(uniformName);
+		uniforms.push_back(uniform);
+	}
+
+	std::sort(uniforms.begin(), uniforms.end(), [](const Uniform &a, const Uniform &b) { return a.id < b.id; });
+	for (size_t i = 1; i < uniforms.size(); ++i) {
+		if (uniforms[i].id == uniforms[i - 1].id) {
+			std::cerr << "Uniform name hash collision in shader " << name << "\n";
+		}
+	}
+}
+
+const Shader::Uniform *Shader::FindUniform(uint32_t id) const {
+	const auto it = std::lower_bound(uniforms.begin(), uniforms.end(), id,
+	                                 [](const Uniform &u, uint32_t key) { return u.id < key; });
+	return (it != uniforms.end() && it->id == id) ? &*it : nullptr;
+}
+
+Shader::Uniform *Shader::UpdateCache(uint32_t id, const void *value, size_t bytes) {
+	Uniform *uniform = FindUniform(id);
+	if (!uniform) {
+		return nullptr;
 	}
-}
\ No newline at end of file
+	assert(bytes <= sizeof(uniform->value));
+	if (uniform->cached && std::memcmp(uniform->value, value, bytes) == 0) {
+		return nullptr;
+	}
+	std::memcpy(uniform->value, value, bytes);
+	uniform->cached = true;
+	return uniform;
+}
+
+void Shader::SetInt(uint32_t id, int value) {
+	if (const Uniform *uniform = UpdateCache(id, &value, sizeof(value))) {
+		glUniform1i(uniform->location, value);
+	}
+}
+
+void Shader::SetFloat(uint32_t id, float value) {
+	if (const Uniform *uniform = UpdateCache(id, &value, sizeof(value))) {
+		glUniform1f(uniform->location, value);
+	}
+}
+
+void Shader::SetVec3(uint32_t id, const Vector3 &value) {
+	const float v[3] = {value.x, value.y, value.z};
+	if (const Uniform *uniform = UpdateCache(id, v, sizeof(v))) {
+		glUniform3fv(uniform->location, 1, v);
+	}
+}
+
+void Shader::SetVec4(uint32_t id, const Vector4 &value) {
+	const float v[4] = {value.x, value.y, value.z, value.w};
+	if (const Uniform *uniform = UpdateCache(id, v, sizeof(v))) {
+		glUniform4fv(uniform->location, 1, v);
+	}
+}
+
+void Shader::SetMat4(uint32_t id, const float *value) {
+	// Matrices are row-major, see Matrix4
+	if (const Uniform *uniform = UpdateCache(id, value, 16 * sizeof(float))) {
+		glUniformMatrix4fv(uniform->location, 1, GL_TRUE, value);
+	}
+}
+
+void Shader::SetIntArray(uint32_t id, const int *values, int count) {
+	if (const Uniform *uniform = FindUniform(id)) {
+		glUniform1iv(uniform->location, GH_MIN(count, uniform->size), values);
+	}
+}
+
+void Shader::SetMat4Array(uint32_t id, const float *values, int count) {
+	if (const Uniform *uniform = FindUniform(id)) {
+		glUniformMatrix4fv(uniform->location, GH_MIN(count, uniform->size), GL_TRUE, values);
+	}
+}
@@ -0,0 +1,136 @@
+#include "rendering/ShaderCache.h"
+#include "core/engine/GameHeader.h"
+#include "core/util/Hash.h"
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <vector>
+
+namespace {
+	constexpr uint32_t CACHE_MAGIC = 0x4353454E; // "NESC"
+	constexpr uint32_t CACHE_VERSION = 1;
+	// Program binaries are a few hundred KB at most, anything larger is a corrupt header
+	constexpr uint32_t MAX_BINARY_BYTES = 64u << 20;
+
+	struct CacheHeader {
+		uint32_t magic;
+		uint32_t version;
+		uint64_t key;
+		uint32_t format;
+		uint32_t length;
+	};
+
+	const char *GLString(GLenum name) {
+		const auto *str = reinterpret_cast<const char *>(glGetString(name));
+		return str ? str : "";
+	}
+}
+
+int ShaderCache::hits = 0;
+int ShaderCache::misses = 0;
+
+bool ShaderCache::IsSupported() {
+	static const bool supported = [] {
+		if (!GH_USE_SHADER_CACHE || !GLEW_ARB_get_program_binary) {
+			return false;
+		}
+		GLint numFormats = 0;
+		glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &numFormats);
+		return numFormats > 0;
+	}();
+	return supported;
+}
+
+uint64_t ShaderCache::MakeKey(const std::string &vertSource, const std::string &fragSource) {
+	uint64_t key = HashFNV64(vertSource);
+	key = HashFNV64("\0", 1, key);
+	key = HashFNV64(fragSource, key);
+	key = HashFNV64(GLString(GL_VENDOR), key);
+	key = HashFNV64(GLString(GL_RENDERER), key);
+	key = HashFNV64(GLString(GL_VERSION), key);
+	return key;
+}
+
+std::string ShaderCache::PathFor(const std::string &name) {
+	return std::string(GH_SHADER_CACHE_DIR) + name + ".bin";
+}
+
+bool ShaderCache::Load(GLuint progId, const std::string &name, uint64_t key) {
+	if (!IsSupported()) {
+		return false;
+	}
+
+	std::ifstream file(PathFor(name), std::ios::binary | std::ios::ate);
+	const std::streamoff size = file ? static_cast<std::streamoff>(file.tellg()) : 0;
+	file.seekg(0);
+	CacheHeader header{};
+	if (!file || !file.read(reinterpret_cast<char *>(&header), sizeof(header)) ||
+	    header.magic != CACHE_MAGIC || header.version != CACHE_VERSION || header.key != key) {
+		misses += 1;
+		return false;
+	}
+	// The stored length is only trusted if the file really holds that many bytes
+	if (header.length == 0 || header.length > MAX_BINARY_BYTES ||
+	    static_cast<std::streamoff>(header.length) != size - static_cast<std::streamoff>(sizeof(header))) {
+		std::cout << "Shader cache entry corrupt: " << name << "\n";
+		misses += 1;
+		return false;
+	}
+
+	std::vector<char> binary(header.length);
+	if (!file.read(binary.data(), header.length)) {
+		misses += 1;
+		return false;
+	}
+
+	glProgramBinary(progId, header.format, binary.data(), static_cast<GLsizei>(header.length));
+
+	// The driver may reject a binary it produced itself (e.g. after an update)
+	GLint success = GL_FALSE;
+	glGetProgramiv(progId, GL_LINK_STATUS, &success);
+	if (!success) {
+		std::cout << "Shader cache entry rejected by driver: " << name << "\n";
+		misses += 1;
+		return false;
+	}
+
+	hits += 1;
+	return true;
+}
+
+void ShaderCache::Store(GLuint progId, const std::string &name, uint64_t key) {
+	if (!IsSupported()) {
+		return;
+	}
+
+	GLint length = 0;
+	glGetProgramiv(progId, GL_PROGRAM_BINARY_LENGTH, &length);
+	if (length <= 0) {
+		return;
+	}
+
+	std::vector<char> binary(length);
+	GLenum format = 0;
+	glGetProgramBinary(progId, length, nullptr, &format, binary.data());
+
+	const CacheHeader header{CACHE_MAGIC, CACHE_VERSION, key, format, static_cast<uint32_t>(length)};
+	const std::string path = PathFor(name);
+	const std::string tmpPath = path + ".tmp";
+	try {
+		std::filesystem::create_directories(GH_SHADER_CACHE_DIR);
+
+		// Write to a temporary file first so a crash never leaves a truncated entry
+		{
+			std::ofstream file(tmpPath, std::ios::binary | std::ios::trunc);
+			file.write(reinterpret_cast<const char *>(&header), sizeof(header));
+			file.write(binary.data(), length);
+			if (!file) {
+				std::cerr << "Failed to write shader cache: " << tmpPath << "\n";
+				return;
+			}
+		}
+		std::filesystem::rename(tmpPath, path);
+	} catch (const std::filesystem::filesystem_error &e) {
+		std::cerr << "Filesystem error writing shader cache: " << e.what() << "\n";
+	}
+}
@@ -1,125 +1,263 @@
 #include "rendering/Texture.h"
-#include <fstream>
+#include "core/engine/GameHeader.h"
+#include "rendering/GLState.h"
+#include "resources/BmpImage.h"
+#include <algorithm>
 #include <cassert>
+#include <cstdint>
+#include <cstring>
 #include <iostream>
 
 #define STB_IMAGE_IMPLEMENTATION
 #include "stb_image.h"
 
-Texture::Texture(const char *fname, int rows, int cols, TextureType type) : type(type) {
-	std::string path = std::string("assets/textures/") + fname;
-	std::string ext = path.substr(path.find_last_of('.') + 1);
+Texture::Texture(const char *fname, int rows, int cols, TextureType type) {
+	SetSource(fname, rows, cols, type);
+	TextureSource src;
+	if (Decode(fname, rows, cols, type, src)) {
+		Finish(src, src.pixels.get());
+	}
+}
+
+bool Texture::Decode(const std::string &fname, int rows, int cols, TextureType type, TextureSource &src) {
+	const std::string path = "assets/textures/" + fname;
+	const std::string ext = path.substr(path.find_last_of('.') + 1);
+	src.type = type;
 
 	// Check file extension to determine loading method
 	if (ext == "bmp") {
-		LoadBMP(path, rows, cols);
+		// Prefer the offline compressed version, see tools/texture_compressor.cpp
+		const std::string dds = DdsPathFor(path);
+		if (GH_USE_COMPRESSED_TEXTURES && DdsIsUpToDate(path, dds) && DecodeDDS(dds, rows, cols, src)) {
+			return true;
+		}
+		return DecodeBMP(path, rows, cols, src);
+	} else if (ext == "dds") {
+		return DecodeDDS(path, rows, cols, src);
 	} else if (ext == "hdr") {
-		isHDR = true;
-		LoadHDR(path);
+		return DecodeHDR(path, src);
 	} else {
 		// Handle other formats with stb_image
-		LoadSTB(path);
+		return DecodeSTB(path, type, src);
 	}
 }
 
-bool Texture::LoadBMP(const std::string& path, int rows, int cols) {
-	// Check if this is a 3D texture
-	assert(rows >= 1 && cols >= 1);
-	is3D = (rows > 1 || cols > 1);
-
-	// Open the bitmap
-	std::ifstream fin(path, std::ios::in | std::ios::binary);
-	if (!fin) {
-		std::cerr << "Failed to open texture file: " << path << std::endl;
-		texId = 0;
+bool Texture::DecodeArray(const std::vector<std::string> &fnames, TextureSource &src) {
+	std::vector<TextureSource> layers(fnames.size());
+	for (size_t i = 0; i < fnames.size(); ++i) {
+		if (!Decode(fnames[i], 1, 1, TextureType::DIFFUSE, layers[i])) {
+			return false;
+		}
+	}
+	if (layers.empty()) {
 		return false;
 	}
 
-	// Read the bitmap
-	char input[54];
-	fin.read(input, 54);
-	const GLsizei width = *reinterpret_cast<int32_t *>(&input[18]);
-	const GLsizei height = *reinterpret_cast<int32_t *>(&input[22]);
-	assert(width % cols == 0);
-	assert(height % rows == 0);
-	const int block_w = width / cols;
-	const int block_h = height / rows;
-	auto *img = new uint8_t[width * height * 3];
-	for (int y = height; y-- > 0;) {
-		const int row = y / block_h;
-		const int ty = y % block_h;
-		for (int x = 0; x < width; x++) {
-			const int col = x / block_w;
-			const int tx = x % block_w;
-			uint8_t *ptr = img + ((row * cols + col) * (block_w * block_h) + ty * block_w + tx) * 3;
-			fin.read(reinterpret_cast<char *>(ptr), 3);
+	// Every layer must share size and format, otherwise go back to the BMPs and resample
+	const TextureSource &first = layers[0];
+	bool uniform = true;
+	for (const TextureSource &layer: layers) {
+		uniform &= layer.target == GL_TEXTURE_2D && layer.width == first.width && layer.height == first.height &&
+		           layer.internalFormat == first.internalFormat && layer.format == first.format &&
+		           layer.dataType == first.dataType && layer.levels.size() == first.levels.size();
+	}
+	if (!uniform) {
+		int width = 0, height = 0;
+		for (size_t i = 0; i < fnames.size(); ++i) {
+			layers[i] = TextureSource();
+			if (!DecodeBMP("assets/textures/" + fnames[i], 1, 1, layers[i])) {
+				return false;
+			}
+			width = std::max(width, layers[i].width);
+			height = std::max(height, layers[i].height);
 		}
-		const int padding = (width * 3) % 4;
-		if (padding) {
-			char junk[3];
-			fin.read(junk, 4 - padding);
+		for (TextureSource &layer: layers) {
+			if (layer.width == width && layer.height == height) {
+				continue;
+			}
+			// Nearest neighbour, level textures are low resolution pixel art
+			const size_t size = static_cast<size_t>(width) * height * 3;
+			std::unique_ptr<void, void (*)(void *)> pixels(std::malloc(size), std::free);
+			const auto *in = static_cast<const uint8_t *>(layer.pixels.get());
+			auto *out = static_cast<uint8_t *>(pixels.get());
+			for (int y = 0; y < height; ++y) {
+				const int sy = y * layer.height / height;
+				for (int x = 0; x < width; ++x) {
+					const int sx = x * layer.width / width;
+					std::memcpy(out + (static_cast<size_t>(y) * width + x) * 3,
+					            in + (static_cast<size_t>(sy) * layer.width + sx) * 3, 3);
+				}
+			}
+			layer.pixels = std::move(pixels);
+			layer.size = size;
+			layer.width = width;
+			layer.height = height;
 		}
 	}
 
-	// Load texture into video memory
-	glGenTextures(1, &texId);
-	if (is3D) {
-		glBindTexture(GL_TEXTURE_2D_ARRAY, texId);
-		glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_NEAREST);
-		glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-		glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_S, GL_REPEAT);
-		glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_T, GL_REPEAT);
-		glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_GENERATE_MIPMAP, GL_TRUE);
-		glGenerateMipmap(GL_TEXTURE_2D);
-		glTexImage3D(GL_TEXTURE_2D_ARRAY, 0, GL_RGB8, width / rows, height / cols, rows * cols, 0, GL_BGR,
-		             GL_UNSIGNED_BYTE, img);
+	// Same settings as a single layer, the data is every layer one after the other
+	src.target = GL_TEXTURE_2D_ARRAY;
+	src.internalFormat = layers[0].internalFormat;
+	src.format = layers[0].format;
+	src.dataType = layers[0].dataType;
+	src.width = layers[0].width;
+	src.height = layers[0].height;
+	src.layers = static_cast<int>(layers.size());
+	src.minFilter = layers[0].minFilter;
+	src.magFilter = layers[0].magFilter;
+	src.wrap = layers[0].wrap;
+	src.mipmaps = layers[0].mipmaps;
+	src.type = TextureType::DIFFUSE;
+	src.size = 0;
+	for (const TextureSource &layer: layers) {
+		src.size += layer.size;
+	}
+	src.pixels.reset(std::malloc(src.size));
+	if (!src.pixels) {
+		return false;
+	}
+	auto *dst = static_cast<char *>(src.pixels.get());
+	if (layers[0].levels.empty()) {
+		for (const TextureSource &layer: layers) {
+			std::memcpy(dst, layer.pixels.get(), layer.size);
+			dst += layer.size;
+		}
+		return true;
+	}
+	// Compressed levels stay level-major, as glCompressedTexImage3D wants them
+	src.levels.clear();
+	size_t offset = 0;
+	for (size_t i = 0; i < layers[0].levels.size(); ++i) {
+		const DdsImage::Mip &level = layers[0].levels[i];
+		src.levels.push_back({offset, level.size * layers.size(), level.width, level.height});
+		for (const TextureSource &layer: layers) {
+			std::memcpy(dst + offset, static_cast<const char *>(layer.pixels.get()) + layer.levels[i].offset,
+			            level.size);
+			offset += level.size;
+		}
+	}
+	return true;
+}
+
+bool Texture::DecodeBMP(const std::string &path, int rows, int cols, TextureSource &src) {
+	// Check if this is a 3D texture
+	assert(rows >= 1 && cols >= 1);
+	const bool array = (rows > 1 || cols > 1);
+
+	BmpImage image;
+	if (!LoadBMP(path, rows, cols, image)) {
+		return false;
+	}
+	src.pixels = std::move(image.pixels);
+	src.size = image.size;
+	src.width = image.width;
+	src.height = image.height;
+	src.layers = image.layers;
+
+	// Pixels stay BGR, GL swizzles them during the upload
+	src.internalFormat = GL_RGB8;
+	src.format = GL_BGR;
+	src.dataType = GL_UNSIGNED_BYTE;
+	src.wrap = GL_REPEAT;
+	if (array) {
+		// Every block of the atlas becomes a layer
+		src.target = GL_TEXTURE_2D_ARRAY;
+		src.minFilter = GL_LINEAR_MIPMAP_NEAREST;
+		src.magFilter = GL_LINEAR;
+		src.mipmaps = true;
 	} else {
-		glBindTexture(GL_TEXTURE_2D, texId);
-		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
-		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
-		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
-		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
-		glTexImage2D(GL_TEXTURE_2D, 0, GL_RGB8, width, height, 0, GL_BGR, GL_UNSIGNED_BYTE, img);
+		src.target = GL_TEXTURE_2D;
+		src.minFilter = GL_NEAREST;
+		src.magFilter = GL_NEAREST;
+	}
+	return true;
+}
+
+bool Texture::DecodeDDS(const std::string &path, int rows, int cols, TextureSource &src) {
+	assert(rows >= 1 && cols >= 1);
+	DdsImage image;
+	if (!LoadDDS(path, image)) {
+		return false;
+	}
+	const bool array = (rows > 1 || cols > 1);
+	if (image.layers != rows * cols) {
+		std::cerr << "DDS layer count does not match the atlas: " << path << std::endl;
+		return false;
+	}
+
+	// GLEW flags are plain globals written once by glewInit, safe to read here
+	switch (image.format) {
+		case BlockFormat::BC1:
+		case BlockFormat::BC3:
+			if (!GLEW_EXT_texture_compression_s3tc) {
+				return false;
+			}
+			src.internalFormat = image.format == BlockFormat::BC1 ? GL_COMPRESSED_RGB_S3TC_DXT1_EXT
+			                                                      : GL_COMPRESSED_RGBA_S3TC_DXT5_EXT;
+			break;
+		case BlockFormat::BC7:
+			if (!GLEW_ARB_texture_compression_bptc) {
+				return false;
+			}
+			src.internalFormat = GL_COMPRESSED_RGBA_BPTC_UNORM;
+			break;
 	}
 
-	// Cleanup
-	delete[] img;
+	src.pixels = std::move(image.data);
+	src.size = image.size;
+	src.width = image.width;
+	src.height = image.height;
+	src.layers = image.layers;
+	src.levels = std::move(image.mips);
+	src.wrap = GL_REPEAT;
+	// Same look as the BMP path, plus the precomputed mip chain when minified
+	if (array) {
+		src.target = GL_TEXTURE_2D_ARRAY;
+		src.minFilter = GL_LINEAR_MIPMAP_NEAREST;
+		src.magFilter = GL_LINEAR;
+	} else {
+		src.target = GL_TEXTURE_2D;
+		src.minFilter = src.levels.size() > 1 ? GL_NEAREST_MIPMAP_LINEAR : GL_NEAREST;
+		src.magFilter = GL_NEAREST;
+	}
 	return true;
 }
 
-bool Texture::LoadHDR(const std::string& path) {
+bool Texture::DecodeHDR(const std::string &path, TextureSource &src) {
 	int width, height, channels;
-	float* data = stbi_loadf(path.c_str(), &width, &height, &channels, 0);
+	float *data = stbi_loadf(path.c_str(), &width, &height, &channels, 3);
 	if (!data) {
 		std::cerr << "Failed to load HDR texture: " << path << std::endl;
-		texId = 0;
 		return false;
 	}
-
-	glGenTextures(1, &texId);
-	glBindTexture(GL_TEXTURE_2D, texId);
+	src.pixels = {data, stbi_image_free};
+	src.size = static_cast<size_t>(width) * height * 3 * sizeof(float);
 
 	// Use floating point format for HDR
-	glTexImage2D(GL_TEXTURE_2D, 0, GL_RGB16F, width, height, 0, GL_RGB, GL_FLOAT, data);
-
-	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
-	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
-	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
-	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-
-	stbi_image_free(data);
+	src.target = GL_TEXTURE_2D;
+	src.width = width;
+	src.height = height;
+	src.internalFormat = GL_RGB16F;
+	src.format = GL_RGB;
+	src.dataType = GL_FLOAT;
+	src.wrap = GL_CLAMP_TO_EDGE;
+	src.minFilter = GL_LINEAR;
+	src.magFilter = GL_LINEAR;
+	src.isHDR = true;
 	return true;
 }
 
-bool Texture::LoadSTB(const std::string& path) {
+bool Texture::DecodeSTB(const std::string &path, TextureType type, TextureSource &src) {
 	int width, height, channels;
-	stbi_set_flip_vertically_on_load(true);
-	unsigned char* data = stbi_load(path.c_str(), &width, &height, &channels, 0);
+	// Per thread flag, decoding may run on several loader threads
+	stbi_set_flip_vertically_on_load_thread(true);
+	unsigned char *data = stbi_load(path.c_str(), &width, &height, &channels, 0);
 	if (!data) {
 		std::cerr << "Failed to load texture: " << path << std::endl;
-		texId = 0;
 		return false;
 	}
+	src.pixels = {data, stbi_image_free};
+	src.size = static_cast<size_t>(width) * height * channels;
 
 	GLenum format;
 	GLenum internalFormat;
@@ -134,14 +272,9 @@ bool Texture::LoadSTB(const std::string& path) {
 		internalFormat = GL_RGBA8;
 	} else {
 		std::cerr << "Unsupported number of channels: " << channels << std::endl;
-		stbi_image_free(data);
-		texId = 0;
 		return false;
 	}
 
-	glGenTextures(1, &texId);
-	glBindTexture(GL_TEXTURE_2D, texId);
-
 	// Choose appropriate format based on texture type
 	if (type == TextureType::NORMAL || type == TextureType::HEIGHT) {
 		// Normal maps need more precision
@@ -151,27 +284,82 @@ bool Texture::LoadSTB(const std::string& path) {
 		internalFormat = (channels == 1) ? GL_R8 : GL_RGB8;
 	}
 
-	glTexImage2D(GL_TEXTURE_2D, 0, internalFormat, width, height, 0, format, GL_UNSIGNED_BYTE, data);
-	glGenerateMipmap(GL_TEXTURE_2D);
+	src.target = GL_TEXTURE_2D;
+	src.width = width;
+	src.height = height;
+	src.internalFormat = static_cast<GLint>(internalFormat);
+	src.format = format;
+	src.dataType = GL_UNSIGNED_BYTE;
+	src.wrap = GL_REPEAT;
+	src.minFilter = GL_LINEAR_MIPMAP_LINEAR;
+	src.magFilter = GL_LINEAR;
+	src.mipmaps = true;
+	return true;
+}
 
-	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
-	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
-	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
-	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+void Texture::Finish(const TextureSource &src, const void *pixels) {
+	is3D = (src.target == GL_TEXTURE_2D_ARRAY);
+	isHDR = src.isHDR;
+	type = src.type;
 
-	stbi_image_free(data);
-	return true;
+	glGenTextures(1, &texId);
+	GLState::BindTexture(src.target, texId);
+	glTexParameteri(src.target, GL_TEXTURE_WRAP_S, src.wrap);
+	glTexParameteri(src.target, GL_TEXTURE_WRAP_T, src.wrap);
+	glTexParameteri(src.target, GL_TEXTURE_MIN_FILTER, src.minFilter);
+	glTexParameteri(src.target, GL_TEXTURE_MAG_FILTER, src.magFilter);
+
+	if (!src.levels.empty()) {
+		// Compressed blocks go straight to the GPU, one call per level
+		glTexParameteri(src.target, GL_TEXTURE_BASE_LEVEL, 0);
+		glTexParameteri(src.target, GL_TEXTURE_MAX_LEVEL, static_cast<GLint>(src.levels.size()) - 1);
+		size_t gpuBytes = 0;
+		for (size_t i = 0; i < src.levels.size(); ++i) {
+			const DdsImage::Mip &level = src.levels[i];
+			gpuBytes += level.size;
+			const void *data = reinterpret_cast<const void *>(reinterpret_cast<uintptr_t>(pixels) + level.offset);
+			if (is3D) {
+				glCompressedTexImage3D(src.target, static_cast<GLint>(i), static_cast<GLenum>(src.internalFormat),
+				                       level.width, level.height, src.layers, 0, static_cast<GLsizei>(level.size),
+				                       data);
+			} else {
+				glCompressedTexImage2D(src.target, static_cast<GLint>(i), static_cast<GLenum>(src.internalFormat),
+				                       level.width, level.height, 0, static_cast<GLsizei>(level.size), data);
+			}
+		}
+		memory.Set(0, gpuBytes);
+		return;
+	}
+
+	// Decoded rows are tightly packed
+	glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+	if (is3D) {
+		glTexImage3D(src.target, 0, src.internalFormat, src.width, src.height, src.layers, 0, src.format,
+		             src.dataType, pixels);
+	} else {
+		glTexImage2D(src.target, 0, src.internalFormat, src.width, src.height, 0, src.format, src.dataType, pixels);
+	}
+	if (src.mipmaps) {
+		glGenerateMipmap(src.target);
+	}
+	memory.Set(0, src.mipmaps ? src.size + src.size / 3 : src.size);
+}
+
+void Texture::SetSource(const std::string &fname, int rows, int cols, TextureType textureType) {
+	name = fname;
+	tiles = rows * cols;
+	type = textureType;
+}
+
+bool Texture::IsPackable() const {
+	return tiles == 1 && type == TextureType::DIFFUSE && name.ends_with(".bmp");
 }
 
 Texture::~Texture() {
+	GLState::OnDeleteTexture(texId);
 	glDeleteTextures(1, &texId);
 }
 
 void Texture::Use(unsigned int slot) const {
-	glActiveTexture(GL_TEXTURE0 + slot);
-	if (is3D) {
-		glBindTexture(GL_TEXTURE_2D_ARRAY, texId);
-	} else {
-		glBindTexture(GL_TEXTURE_2D, texId);
-	}
-}
\ No newline at end of file
+	GLState::BindTexture(is3D ? GL_TEXTURE_2D_ARRAY : GL_TEXTURE_2D, texId, slot);
+}
@@ -0,0 +1,32 @@
+#include "rendering/ViewSet.h"
+#include "rendering/Shader.h"
+#include <algorithm>
+#include <cstring>
+
+void ViewSet::Clear() {
+	count = 0;
+	boundShaders.clear();
+}
+
+int ViewSet::Add(const Camera &cam, const Portal *skipPortal) {
+	if (count >= GH_MULTIVIEW_MAX_VIEWS) {
+		return -1;
+	}
+	const int i = count++;
+	cams[i] = cam;
+	skip[i] = skipPortal;
+	std::memcpy(&viewProj[i * 16], cam.Matrix().m, sizeof(float) * 16);
+	std::memcpy(&invProj[i * 16], cam.projection.Inverse().m, sizeof(float) * 16);
+	std::memcpy(&invView[i * 16], cam.worldView.Inverse().m, sizeof(float) * 16);
+	return i;
+}
+
+void ViewSet::Bind(Shader &shader) const {
+	if (std::find(boundShaders.begin(), boundShaders.end(), &shader) != boundShaders.end()) {
+		return;
+	}
+	boundShaders.push_back(&shader);
+	shader.SetMat4Array(UniformId("viewProj"), viewProj, count);
+	shader.SetMat4Array(UniformId("invProj"), invProj, count);
+	shader.SetMat4Array(UniformId("invView"), invView, count);
+}
@@ -0,0 +1,121 @@
+#include "resources/BmpImage.h"
+#include "resources/MappedFile.h"
+#include <cstring>
+#include <iostream>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define BMP_SSE2
+#elif defined(__ARM_NEON)
+#include <arm_neon.h>
+#define BMP_NEON
+#endif
+
+namespace {
+	constexpr size_t BMP_HEADER_SIZE = 54;
+
+	uint32_t ReadU32(const char *p) {
+		uint32_t v;
+		std::memcpy(&v, p, sizeof(v));
+		return v;
+	}
+
+	int32_t ReadI32(const char *p) {
+		int32_t v;
+		std::memcpy(&v, p, sizeof(v));
+		return v;
+	}
+
+	uint16_t ReadU16(const char *p) {
+		uint16_t v;
+		std::memcpy(&v, p, sizeof(v));
+		return v;
+	}
+
+	// Copy one tile row, 64 bytes per iteration with unaligned vector loads
+	void CopyRow(uint8_t *dst, const uint8_t *src, size_t bytes) {
+		size_t i = 0;
+#if defined(BMP_SSE2)
+		for (; i + 64 <= bytes; i += 64) {
+			const __m128i a = _mm_loadu_si128(reinterpret_cast<const __m128i *>(src + i));
+			const __m128i b = _mm_loadu_si128(reinterpret_cast<const __m128i *>(src + i + 16));
+			const __m128i c = _mm_loadu_si128(reinterpret_cast<const __m128i *>(src + i + 32));
+			const __m128i d = _mm_loadu_si128(reinterpret_cast<const __m128i *>(src + i + 48));
+			_mm_storeu_si128(reinterpret_cast<__m128i *>(dst + i), a);
+			_mm_storeu_si128(reinterpret_cast<__m128i *>(dst + i + 16), b);
+			_mm_storeu_si128(reinterpret_cast<__m128i *>(dst + i + 32), c);
+			_mm_storeu_si128(reinterpret_cast<__m128i *>(dst + i + 48), d);
+		}
+#elif defined(BMP_NEON)
+		for (; i + 64 <= bytes; i += 64) {
+			const uint8x16_t a = vld1q_u8(src + i);
+			const uint8x16_t b = vld1q_u8(src + i + 16);
+			const uint8x16_t c = vld1q_u8(src + i + 32);
+			const uint8x16_t d = vld1q_u8(src + i + 48);
+			vst1q_u8(dst + i, a);
+			vst1q_u8(dst + i + 16, b);
+			vst1q_u8(dst + i + 32, c);
+			vst1q_u8(dst + i + 48, d);
+		}
+#endif
+		std::memcpy(dst + i, src + i, bytes - i);
+	}
+}
+
+bool LoadBMP(const std::string &path, int rows, int cols, BmpImage &image) {
+	const MappedFile file(path);
+	if (!file.IsOpen() || file.Size() < BMP_HEADER_SIZE || file.Data()[0] != 'B' || file.Data()[1] != 'M') {
+		std::cerr << "Failed to open texture file: " << path << std::endl;
+		return false;
+	}
+
+	const char *header = file.Data();
+	const uint32_t dataOffset = ReadU32(header + 10);
+	const int32_t width = ReadI32(header + 18);
+	const int32_t rawHeight = ReadI32(header + 22);
+	const uint16_t bpp = ReadU16(header + 28);
+	const uint32_t compression = ReadU32(header + 30);
+	// Negative height means the rows are stored top-down
+	const bool topDown = rawHeight < 0;
+	const int32_t height = topDown ? -rawHeight : rawHeight;
+	if (bpp != 24 || compression != 0 || width <= 0 || height <= 0 || rows < 1 || cols < 1 ||
+	    width % cols != 0 || height % rows != 0) {
+		std::cerr << "Unsupported BMP (24-bit uncompressed, size divisible by the tiling): " << path << std::endl;
+		return false;
+	}
+
+	const size_t rowBytes = static_cast<size_t>(width) * 3;
+	const size_t stride = (rowBytes + 3) & ~static_cast<size_t>(3);
+	if (dataOffset > file.Size() || file.Size() - dataOffset < stride * (height - 1) + rowBytes) {
+		std::cerr << "Truncated BMP: " << path << std::endl;
+		return false;
+	}
+
+	const int block_w = width / cols;
+	const int block_h = height / rows;
+	const size_t tileRowBytes = static_cast<size_t>(block_w) * 3;
+	const size_t tileBytes = tileRowBytes * block_h;
+	image.size = rowBytes * height;
+	image.pixels.reset(std::malloc(image.size));
+	if (!image.pixels) {
+		return false;
+	}
+	image.width = block_w;
+	image.height = block_h;
+	image.layers = rows * cols;
+
+	// Image row y (0 = top) goes to row y % block_h of the tiles in tile row y / block_h
+	const auto *src = reinterpret_cast<const uint8_t *>(file.Data() + dataOffset);
+	auto *dst = static_cast<uint8_t *>(image.pixels.get());
+	for (int r = 0; r < height; ++r) {
+		const int y = topDown ? r : height - 1 - r;
+		const int row = y / block_h;
+		const int ty = y % block_h;
+		const uint8_t *line = src + stride * r;
+		uint8_t *tile = dst + static_cast<size_t>(row) * cols * tileBytes + ty * tileRowBytes;
+		for (int col = 0; col < cols; ++col) {
+			CopyRow(tile + col * tileBytes, line + col * tileRowBytes, tileRowBytes);
+		}
+	}
+	return true;
+}
@@ -0,0 +1,216 @@
+#include "resources/DdsImage.h"
+#include "resources/MappedFile.h"
+#include <algorithm>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+
+namespace {
+	constexpr uint32_t DDS_MAGIC = 0x20534444; // "DDS "
+	constexpr uint32_t FOURCC_DXT1 = 0x31545844;
+	constexpr uint32_t FOURCC_DXT5 = 0x35545844;
+	constexpr uint32_t FOURCC_DX10 = 0x30315844;
+	constexpr uint32_t DXGI_BC1_UNORM = 71;
+	constexpr uint32_t DXGI_BC3_UNORM = 77;
+	constexpr uint32_t DXGI_BC7_UNORM = 98;
+	constexpr uint32_t DDS_DIMENSION_TEXTURE2D = 3;
+	// Past the GL limits, headers beyond these are corrupt. Sizes computed within them fit size_t.
+	constexpr uint32_t MAX_DIMENSION = 16384;
+	constexpr uint32_t MAX_LAYERS = 2048;
+
+	constexpr uint32_t DDSD_REQUIRED = 0x1 | 0x2 | 0x4 | 0x1000; // caps, height, width, pixel format
+	constexpr uint32_t DDSD_MIPMAPCOUNT = 0x20000;
+	constexpr uint32_t DDSD_LINEARSIZE = 0x80000;
+	constexpr uint32_t DDPF_FOURCC = 0x4;
+	constexpr uint32_t DDSCAPS_COMPLEX = 0x8;
+	constexpr uint32_t DDSCAPS_TEXTURE = 0x1000;
+	constexpr uint32_t DDSCAPS_MIPMAP = 0x400000;
+
+	struct PixelFormat {
+		uint32_t size;
+		uint32_t flags;
+		uint32_t fourCC;
+		uint32_t rgbBitCount;
+		uint32_t masks[4];
+	};
+
+	struct Header {
+		uint32_t size;
+		uint32_t flags;
+		uint32_t height;
+		uint32_t width;
+		uint32_t pitchOrLinearSize;
+		uint32_t depth;
+		uint32_t mipMapCount;
+		uint32_t reserved1[11];
+		PixelFormat pixelFormat;
+		uint32_t caps[4];
+		uint32_t reserved2;
+	};
+
+	struct HeaderDX10 {
+		uint32_t dxgiFormat;
+		uint32_t resourceDimension;
+		uint32_t miscFlag;
+		uint32_t arraySize;
+		uint32_t miscFlags2;
+	};
+
+	static_assert(sizeof(Header) == 124 && sizeof(HeaderDX10) == 20, "DDS header layout");
+}
+
+size_t DdsImage::LevelSize(BlockFormat format, int width, int height) {
+	const size_t bw = (static_cast<size_t>(width) + 3) / 4;
+	const size_t bh = (static_cast<size_t>(height) + 3) / 4;
+	return bw * bh * BlockBytes(format);
+}
+
+std::string DdsPathFor(const std::string &path) {
+	return std::filesystem::path(path).replace_extension(".dds").string();
+}
+
+bool DdsIsUpToDate(const std::string &path, const std::string &dds) {
+	std::error_code ec;
+	const auto ddsTime = std::filesystem::last_write_time(dds, ec);
+	if (ec) {
+		return false;
+	}
+	const auto srcTime = std::filesystem::last_write_time(path, ec);
+	// A shipped DDS without its source is fine
+	return ec || ddsTime >= srcTime;
+}
+
+bool LoadDDS(const std::string &path, DdsImage &image) {
+	const MappedFile file(path);
+	if (!file.IsOpen() || file.Size() < 4 + sizeof(Header)) {
+		return false;
+	}
+	const char *cur = file.Data();
+	uint32_t magic;
+	std::memcpy(&magic, cur, 4);
+	Header header{};
+	std::memcpy(&header, cur + 4, sizeof(header));
+	size_t offset = 4 + sizeof(header);
+	if (magic != DDS_MAGIC || header.size != sizeof(Header) || !(header.pixelFormat.flags & DDPF_FOURCC)) {
+		std::cerr << "Unsupported DDS file: " << path << std::endl;
+		return false;
+	}
+
+	int layers = 1;
+	const uint32_t fourCC = header.pixelFormat.fourCC;
+	if (fourCC == FOURCC_DXT1) {
+		image.format = BlockFormat::BC1;
+	} else if (fourCC == FOURCC_DXT5) {
+		image.format = BlockFormat::BC3;
+	} else if (fourCC == FOURCC_DX10 && file.Size() >= offset + sizeof(HeaderDX10)) {
+		HeaderDX10 dx10{};
+		std::memcpy(&dx10, cur + offset, sizeof(dx10));
+		offset += sizeof(dx10);
+		if (dx10.resourceDimension != DDS_DIMENSION_TEXTURE2D || dx10.arraySize == 0 ||
+		    dx10.arraySize > MAX_LAYERS) {
+			std::cerr << "Unsupported DDS dimension: " << path << std::endl;
+			return false;
+		}
+		layers = static_cast<int>(dx10.arraySize);
+		if (dx10.dxgiFormat == DXGI_BC1_UNORM) {
+			image.format = BlockFormat::BC1;
+		} else if (dx10.dxgiFormat == DXGI_BC3_UNORM) {
+			image.format = BlockFormat::BC3;
+		} else if (dx10.dxgiFormat == DXGI_BC7_UNORM) {
+			image.format = BlockFormat::BC7;
+		} else {
+			std::cerr << "Unsupported DDS format " << dx10.dxgiFormat << ": " << path << std::endl;
+			return false;
+		}
+	} else {
+		std::cerr << "Unsupported DDS format: " << path << std::endl;
+		return false;
+	}
+
+	if (header.width == 0 || header.height == 0 || header.width > MAX_DIMENSION || header.height > MAX_DIMENSION) {
+		std::cerr << "Unsupported DDS size " << header.width << "x" << header.height << ": " << path << std::endl;
+		return false;
+	}
+	image.width = static_cast<int>(header.width);
+	image.height = static_cast<int>(header.height);
+	image.layers = layers;
+
+	// No more levels than the chain down to 1x1
+	int maxMips = 1;
+	while ((std::max(image.width, image.height) >> maxMips) > 0) {
+		maxMips += 1;
+	}
+	const int mipCount = (header.flags & DDSD_MIPMAPCOUNT) && header.mipMapCount > 0
+	                     ? static_cast<int>(std::min(header.mipMapCount, static_cast<uint32_t>(maxMips))) : 1;
+
+	// The file is layer-major, GL wants every layer of a level together
+	image.mips.clear();
+	image.size = 0;
+	for (int m = 0, w = image.width, h = image.height; m < mipCount; ++m) {
+		const size_t levelSize = DdsImage::LevelSize(image.format, w, h) * layers;
+		image.mips.push_back({image.size, levelSize, w, h});
+		image.size += levelSize;
+		w = w > 1 ? w / 2 : 1;
+		h = h > 1 ? h / 2 : 1;
+	}
+	if (file.Size() - offset < image.size) {
+		std::cerr << "Truncated DDS file: " << path << std::endl;
+		return false;
+	}
+
+	image.data.reset(std::malloc(image.size));
+	if (!image.data) {
+		return false;
+	}
+	auto *dst = static_cast<char *>(image.data.get());
+	const char *src = cur + offset;
+	for (int layer = 0; layer < layers; ++layer) {
+		for (const DdsImage::Mip &mip: image.mips) {
+			const size_t layerSize = mip.size / layers;
+			std::memcpy(dst + mip.offset + layer * layerSize, src, layerSize);
+			src += layerSize;
+		}
+	}
+	return true;
+}
+
+bool WriteDDS(const std::string &path, BlockFormat format, int width, int height, int layers, int mipCount,
+              const std::vector<uint8_t> &blocks) {
+	Header header{};
+	header.size = sizeof(Header);
+	header.flags = DDSD_REQUIRED | DDSD_MIPMAPCOUNT | DDSD_LINEARSIZE;
+	header.height = static_cast<uint32_t>(height);
+	header.width = static_cast<uint32_t>(width);
+	header.pitchOrLinearSize = static_cast<uint32_t>(DdsImage::LevelSize(format, width, height));
+	header.mipMapCount = static_cast<uint32_t>(mipCount);
+	header.pixelFormat.size = sizeof(PixelFormat);
+	header.pixelFormat.flags = DDPF_FOURCC;
+	header.caps[0] = DDSCAPS_TEXTURE | (mipCount > 1 ? DDSCAPS_COMPLEX | DDSCAPS_MIPMAP : 0);
+
+	// Legacy FourCC where possible, the DX10 extension for BC7 and arrays
+	const bool dx10 = (format == BlockFormat::BC7 || layers > 1);
+	if (dx10) {
+		header.pixelFormat.fourCC = FOURCC_DX10;
+	} else {
+		header.pixelFormat.fourCC = (format == BlockFormat::BC1) ? FOURCC_DXT1 : FOURCC_DXT5;
+	}
+
+	std::ofstream out(path, std::ios::binary | std::ios::trunc);
+	out.write(reinterpret_cast<const char *>(&DDS_MAGIC), sizeof(DDS_MAGIC));
+	out.write(reinterpret_cast<const char *>(&header), sizeof(header));
+	if (dx10) {
+		HeaderDX10 dx10Header{};
+		dx10Header.dxgiFormat = format == BlockFormat::BC1 ? DXGI_BC1_UNORM :
+		                        format == BlockFormat::BC3 ? DXGI_BC3_UNORM : DXGI_BC7_UNORM;
+		dx10Header.resourceDimension = DDS_DIMENSION_TEXTURE2D;
+		dx10Header.arraySize = static_cast<uint32_t>(layers);
+		out.write(reinterpret_cast<const char *>(&dx10Header), sizeof(dx10Header));
+	}
+	out.write(reinterpret_cast<const char *>(blocks.data()), static_cast<std::streamsize>(blocks.size()));
+	if (!out) {
+		std::cerr << "Failed to write DDS file: " << path << std::endl;
+		return false;
+	}
+	return true;
+}
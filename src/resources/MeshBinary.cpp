@@ -0,0 +1,96 @@
+#include "resources/MeshBinary.h"
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+
+namespace {
+	size_t PayloadSize(const MeshBinary::Header &header) {
+		const size_t vc = header.vertexCount;
+		return sizeof(float) * vc * (3 + header.uvSize + 3) +
+		       sizeof(uint32_t) * header.indexCount +
+		       sizeof(float) * 16 * header.colliderCount;
+	}
+}
+
+std::string MeshBinary::PathFor(const std::string &objPath) {
+	return std::filesystem::path(objPath).replace_extension(".nmesh").string();
+}
+
+bool MeshBinary::IsUpToDate(const std::string &objPath, const std::string &binPath) {
+	std::error_code ec;
+	const auto binTime = std::filesystem::last_write_time(binPath, ec);
+	if (ec) {
+		return false;
+	}
+	// A compiled mesh without its source is always usable
+	const auto objTime = std::filesystem::last_write_time(objPath, ec);
+	return ec || binTime >= objTime;
+}
+
+bool MeshBinary::Write(const MeshData &data, const std::string &path) {
+	Header header{};
+	header.magic = MAGIC;
+	header.version = VERSION;
+	header.vertexCount = data.VertexCount();
+	header.indexCount = static_cast<uint32_t>(data.indices.size());
+	header.uvSize = static_cast<uint32_t>(data.uvSize);
+	header.colliderCount = static_cast<uint32_t>(data.colliders.size());
+	header.boundsMin[0] = data.boundsMin.x;
+	header.boundsMin[1] = data.boundsMin.y;
+	header.boundsMin[2] = data.boundsMin.z;
+	header.boundsMax[0] = data.boundsMax.x;
+	header.boundsMax[1] = data.boundsMax.y;
+	header.boundsMax[2] = data.boundsMax.z;
+
+	if (data.uvs.size() != static_cast<size_t>(header.vertexCount) * header.uvSize ||
+	    data.normals.size() != data.verts.size()) {
+		std::cerr << "Mesh attributes do not match the vertex count: " << path << "\n";
+		return false;
+	}
+
+	// Write to a temporary file first so the engine never maps a truncated mesh
+	const std::string tmpPath = path + ".tmp";
+	{
+		std::ofstream file(tmpPath, std::ios::binary | std::ios::trunc);
+		file.write(reinterpret_cast<const char *>(&header), sizeof(header));
+		file.write(reinterpret_cast<const char *>(data.verts.data()), sizeof(float) * data.verts.size());
+		file.write(reinterpret_cast<const char *>(data.uvs.data()), sizeof(float) * data.uvs.size());
+		file.write(reinterpret_cast<const char *>(data.normals.data()), sizeof(float) * data.normals.size());
+		file.write(reinterpret_cast<const char *>(data.indices.data()), sizeof(uint32_t) * data.indices.size());
+		for (const Collider &collider: data.colliders) {
+			file.write(reinterpret_cast<const char *>(collider.Matrix().m), sizeof(float) * 16);
+		}
+		if (!file) {
+			std::cerr << "Failed to write compiled mesh: " << tmpPath << "\n";
+			return false;
+		}
+	}
+	std::error_code ec;
+	std::filesystem::rename(tmpPath, path, ec);
+	if (ec) {
+		std::cerr << "Failed to write compiled mesh: " << path << " (" << ec.message() << ")\n";
+		return false;
+	}
+	return true;
+}
+
+bool MeshBinary::Parse(const void *bytes, size_t size, View &view) {
+	if (size < sizeof(Header)) {
+		return false;
+	}
+	const auto *header = static_cast<const Header *>(bytes);
+	if (header->magic != MAGIC || header->version != VERSION ||
+	    (header->uvSize != 2 && header->uvSize != 3) ||
+	    size != sizeof(Header) + PayloadSize(*header)) {
+		return false;
+	}
+
+	const size_t vc = header->vertexCount;
+	view.header = header;
+	view.verts = reinterpret_cast<const float *>(header + 1);
+	view.uvs = view.verts + vc * 3;
+	view.normals = view.uvs + vc * header->uvSize;
+	view.indices = reinterpret_cast<const uint32_t *>(view.normals + vc * 3);
+	view.colliders = reinterpret_cast<const float *>(view.indices + header->indexCount);
+	return true;
+}
@@ -0,0 +1,298 @@
+#include "resources/MeshData.h"
+#include "core/engine/GameHeader.h"
+#include "core/util/Hash.h"
+#include "resources/MappedFile.h"
+#include <cassert>
+#include <charconv>
+#include <cstdlib>
+#include <cstring>
+#include <unordered_map>
+
+namespace {
+	bool IsSpace(char c) {
+		return c == ' ' || c == '\t';
+	}
+
+	// std::from_chars does not skip whitespace and rejects a leading '+'
+	const char *SkipSpaces(const char *p, const char *end) {
+		while (p < end && (IsSpace(*p) || *p == '+')) {
+			++p;
+		}
+		return p;
+	}
+
+	bool ParseFloat(const char *&p, const char *end, float &value) {
+		p = SkipSpaces(p, end);
+#if defined(__cpp_lib_to_chars)
+		const auto result = std::from_chars(p, end, value);
+		if (result.ec != std::errc()) {
+			return false;
+		}
+		p = result.ptr;
+#else
+		// Standard libraries without floating point from_chars, strtof needs a terminated copy
+		char token[64];
+		size_t n = 0;
+		while (p + n < end && n < sizeof(token) - 1 && !IsSpace(p[n])) {
+			token[n] = p[n];
+			++n;
+		}
+		token[n] = '\0';
+		char *tokenEnd = nullptr;
+		value = std::strtof(token, &tokenEnd);
+		if (tokenEnd == token) {
+			return false;
+		}
+		p += tokenEnd - token;
+#endif
+		return true;
+	}
+
+	bool ParseIndex(const char *&p, const char *end, uint32_t &value) {
+		p = SkipSpaces(p, end);
+		const auto result = std::from_chars(p, end, value);
+		if (result.ec != std::errc()) {
+			return false;
+		}
+		p = result.ptr;
+		return true;
+	}
+
+	void AddFace(
+			MeshData &data, const std::vector<float> &vert_palette, const std::vector<float> &uv_palette,
+			uint32_t a, uint32_t at, uint32_t b, uint32_t bt, uint32_t c, uint32_t ct, bool is3DTex) {
+		//Merge texture and vertex indices
+		assert(a > 0 && b > 0 && c > 0);
+		assert(at > 0 && bt > 0 && ct > 0);
+		a -= 1;
+		b -= 1;
+		c -= 1;
+		at -= 1;
+		bt -= 1;
+		ct -= 1;
+		const uint32_t v_ix[3] = {a, b, c};
+		const uint32_t uv_ix[3] = {at, bt, ct};
+
+		//Calcuate the normal for this face
+		const Vector3 v1(&vert_palette[a * 3]);
+		const Vector3 v2(&vert_palette[b * 3]);
+		const Vector3 v3(&vert_palette[c * 3]);
+		const Vector3 normal = (v2 - v1).Cross(v3 - v1).Normalized();
+
+		for (int i = 0; i < 3; ++i) {
+			const uint32_t v = v_ix[i];
+			const uint32_t vt = uv_ix[i];
+			assert(v < vert_palette.size() / 3);
+			data.verts.push_back(vert_palette[v * 3]);
+			data.verts.push_back(vert_palette[v * 3 + 1]);
+			data.verts.push_back(vert_palette[v * 3 + 2]);
+			if (!uv_palette.empty()) {
+				if (is3DTex) {
+					assert(vt < uv_palette.size() / 3);
+					data.uvs.push_back(uv_palette[vt * 3]);
+					data.uvs.push_back(uv_palette[vt * 3 + 1]);
+					data.uvs.push_back(uv_palette[vt * 3 + 2]);
+				} else {
+					assert(vt < uv_palette.size() / 2);
+					data.uvs.push_back(uv_palette[vt * 2]);
+					data.uvs.push_back(uv_palette[vt * 2 + 1]);
+				}
+			} else {
+				data.uvs.push_back(0.0f);
+				data.uvs.push_back(0.0f);
+			}
+			data.normals.push_back(normal.x);
+			data.normals.push_back(normal.y);
+			data.normals.push_back(normal.z);
+		}
+	}
+}
+
+void MeshData::ComputeBounds() {
+	if (verts.empty()) {
+		boundsMin.SetZero();
+		boundsMax.SetZero();
+		return;
+	}
+	boundsMin = Vector3(&verts[0]);
+	boundsMax = boundsMin;
+	for (size_t i = 3; i < verts.size(); i += 3) {
+		boundsMin.x = GH_MIN(boundsMin.x, verts[i]);
+		boundsMin.y = GH_MIN(boundsMin.y, verts[i + 1]);
+		boundsMin.z = GH_MIN(boundsMin.z, verts[i + 2]);
+		boundsMax.x = GH_MAX(boundsMax.x, verts[i]);
+		boundsMax.y = GH_MAX(boundsMax.y, verts[i + 1]);
+		boundsMax.z = GH_MAX(boundsMax.z, verts[i + 2]);
+	}
+}
+
+void MeshData::Weld() {
+	if (!indices.empty()) {
+		return;
+	}
+	const uint32_t count = VertexCount();
+	const size_t stride = 3 + uvSize + 3;
+	std::vector<float> attribs(stride);
+	std::vector<float> unique;
+	std::unordered_multimap<uint64_t, uint32_t> seen;
+	MeshData welded;
+	welded.uvSize = uvSize;
+	indices.reserve(count);
+
+	for (uint32_t i = 0; i < count; ++i) {
+		std::memcpy(&attribs[0], &verts[i * 3], sizeof(float) * 3);
+		std::memcpy(&attribs[3], &uvs[i * uvSize], sizeof(float) * uvSize);
+		std::memcpy(&attribs[3 + uvSize], &normals[i * 3], sizeof(float) * 3);
+		const uint64_t hash = HashFNV64(attribs.data(), sizeof(float) * stride);
+
+		//Reuse a previous vertex with exactly the same attributes
+		uint32_t index = welded.VertexCount();
+		const auto range = seen.equal_range(hash);
+		for (auto it = range.first; it != range.second; ++it) {
+			if (std::memcmp(&unique[it->second * stride], attribs.data(), sizeof(float) * stride) == 0) {
+				index = it->second;
+				break;
+			}
+		}
+		if (index == welded.VertexCount()) {
+			seen.emplace(hash, index);
+			unique.insert(unique.end(), attribs.begin(), attribs.end());
+			welded.verts.insert(welded.verts.end(), &attribs[0], &attribs[3]);
+			welded.uvs.insert(welded.uvs.end(), &attribs[3], &attribs[3 + uvSize]);
+			welded.normals.insert(welded.normals.end(), &attribs[3 + uvSize], &attribs[stride]);
+		}
+		indices.push_back(index);
+	}
+
+	verts = std::move(welded.verts);
+	uvs = std::move(welded.uvs);
+	normals = std::move(welded.normals);
+}
+
+bool LoadObj(const std::string &path, MeshData &data) {
+	const MappedFile file(path);
+	if (!file.IsOpen()) {
+		return false;
+	}
+
+	// Temporaries
+	std::vector<float> vert_palette;
+	std::vector<float> uv_palette;
+	bool is3DTex = false;
+	data = MeshData();
+
+	// Walk the mapped buffer line by line, nothing is allocated per line
+	const char *cur = file.Data();
+	const char *const fileEnd = cur + file.Size();
+	while (cur < fileEnd) {
+		const char *end = static_cast<const char *>(std::memchr(cur, '\n', fileEnd - cur));
+		if (!end) {
+			end = fileEnd;
+		}
+		const char *next = (end < fileEnd) ? end + 1 : end;
+		if (end > cur && end[-1] == '\r') {
+			--end;
+		}
+		const size_t len = end - cur;
+		const char *p = cur;
+		cur = next;
+
+		if (len > 2 && p[0] == 'v' && p[1] == ' ') {
+			p += 2;
+			float xyz[3];
+			if (ParseFloat(p, end, xyz[0]) && ParseFloat(p, end, xyz[1]) && ParseFloat(p, end, xyz[2])) {
+				vert_palette.insert(vert_palette.end(), xyz, xyz + 3);
+			}
+		} else if (len > 3 && p[0] == 'v' && p[1] == 't' && p[2] == ' ') {
+			p += 3;
+			float u = 0.0f, v = 0.0f, w = 0.0f;
+			ParseFloat(p, end, u);
+			ParseFloat(p, end, v);
+			uv_palette.push_back(u);
+			uv_palette.push_back(v);
+			if (ParseFloat(p, end, w)) {
+				uv_palette.push_back(w);
+				is3DTex = true;
+			}
+		} else if (len > 2 && p[0] == 'c' && p[1] == ' ') {
+			uint32_t a = 0, b = 0, c = 0;
+			if (p[2] == '*') {
+				const uint32_t v_ix = static_cast<uint32_t>(vert_palette.size()) / 3;
+				a = v_ix - 2;
+				b = v_ix - 1;
+				c = v_ix;
+			} else {
+				p += 2;
+				if (!ParseIndex(p, end, a) || !ParseIndex(p, end, b) || !ParseIndex(p, end, c)) {
+					continue;
+				}
+			}
+			const uint32_t numVerts = static_cast<uint32_t>(vert_palette.size()) / 3;
+			if (a == 0 || b == 0 || c == 0 || a > numVerts || b > numVerts || c > numVerts) {
+				continue;
+			}
+			const Vector3 v1(&vert_palette[(a - 1) * 3]);
+			const Vector3 v2(&vert_palette[(b - 1) * 3]);
+			const Vector3 v3(&vert_palette[(c - 1) * 3]);
+			data.colliders.emplace_back(v1, v2, v3);
+		} else if (len > 2 && p[0] == 'f' && p[1] == ' ') {
+			uint32_t v[4] = {};
+			uint32_t vt[4] = {};
+			int count = 0;
+
+			if (p[2] == '*') {
+				// Wildcard faces use the last vertices and uvs that were read
+				const bool isQuad = (len > 3 && p[3] == '*');
+				count = isQuad ? 4 : 3;
+				const uint32_t v_ix = static_cast<uint32_t>(vert_palette.size()) / 3;
+				const uint32_t t_ix = static_cast<uint32_t>(uv_palette.size()) / (is3DTex ? 3 : 2);
+				for (int i = 0; i < count; ++i) {
+					v[i] = v_ix - (count - 1 - i);
+					vt[i] = t_ix - (count - 1 - i);
+				}
+			} else {
+				// Each corner is v, v/vt, v//vn or v/vt/vn. Without a uv the vertex index is used.
+				p += 2;
+				bool valid = true;
+				uint32_t ix = 0;
+				while (valid && ParseIndex(p, end, ix)) {
+					if (count == 4) {
+						valid = false;
+						break;
+					}
+					v[count] = ix;
+					vt[count] = ix;
+					if (p < end && *p == '/') {
+						++p;
+						uint32_t ignored = 0;
+						if (p < end && *p == '/') {
+							++p;
+							valid = ParseIndex(p, end, ignored);
+						} else {
+							valid = ParseIndex(p, end, vt[count]);
+							if (valid && p < end && *p == '/') {
+								++p;
+								valid = ParseIndex(p, end, ignored);
+							}
+						}
+					}
+					++count;
+				}
+				if (!valid || count < 3) {
+					assert(false);
+					continue;
+				}
+			}
+
+			//Add face to list
+			AddFace(data, vert_palette, uv_palette, v[0], vt[0], v[1], vt[1], v[2], vt[2], is3DTex);
+			if (count == 4) {
+				AddFace(data, vert_palette, uv_palette, v[2], vt[2], v[3], vt[3], v[0], vt[0], is3DTex);
+			}
+		}
+	}
+
+	data.uvSize = is3DTex ? 3 : 2;
+	data.ComputeBounds();
+	return true;
+}
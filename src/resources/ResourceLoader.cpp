@@ -0,0 +1,145 @@
+#include "resources/ResourceLoader.h"
+#include "rendering/GLState.h"
+#include <chrono>
+#include <cstring>
+#include <iostream>
+#include <thread>
+
+std::unique_ptr<ThreadPool> ResourceLoader::pool;
+std::mutex ResourceLoader::mutex;
+std::deque<ResourceLoader::Upload> ResourceLoader::ready;
+int ResourceLoader::pendingMeshes = 0;
+int ResourceLoader::pendingTextures = 0;
+GLuint ResourceLoader::pbo = 0;
+size_t ResourceLoader::pboSize = 0;
+
+void ResourceLoader::Start(unsigned int numThreads) {
+	if (!pool) {
+		pool = std::make_unique<ThreadPool>(numThreads);
+	}
+}
+
+void ResourceLoader::Stop() {
+	// Joins the workers, so nothing is pushed after the queue is cleared
+	pool.reset();
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		ready.clear();
+		pendingMeshes = 0;
+		pendingTextures = 0;
+	}
+	if (pbo) {
+		GLState::OnDeleteBuffer(pbo);
+		glDeleteBuffers(1, &pbo);
+		pbo = 0;
+		pboSize = 0;
+	}
+}
+
+void ResourceLoader::LoadMesh(Handle<Mesh> mesh, const std::string &fname) {
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		pendingMeshes += 1;
+	}
+	// The pools belong to the GL thread, handles are only resolved when uploading
+	pool->Submit([mesh, fname] {
+		auto src = std::make_shared<MeshSource>();
+		const bool ok = Mesh::Decode(fname, *src);
+		Push({[mesh, src, ok] {
+			if (Mesh *target = mesh.Get(); target && ok) {
+				target->Finish(*src);
+			} else if (target) {
+				target->Fail();
+			}
+		}, true});
+	});
+}
+
+void ResourceLoader::LoadTexture(Handle<Texture> texture, const std::string &fname, int rows, int cols,
+                                 TextureType type) {
+	SubmitTexture(texture, [fname, rows, cols, type](TextureSource &src) {
+		return Texture::Decode(fname, rows, cols, type, src);
+	});
+}
+
+void ResourceLoader::LoadTextureArray(Handle<Texture> texture, const std::vector<std::string> &fnames) {
+	SubmitTexture(texture, [fnames](TextureSource &src) {
+		return Texture::DecodeArray(fnames, src);
+	});
+}
+
+void ResourceLoader::SubmitTexture(Handle<Texture> texture, std::function<bool(TextureSource &)> decode) {
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		pendingTextures += 1;
+	}
+	pool->Submit([texture, decode = std::move(decode)] {
+		auto src = std::make_shared<TextureSource>();
+		const bool ok = decode(*src);
+		Push({[texture, src, ok] {
+			if (Texture *target = texture.Get(); target && ok) {
+				UploadTexture(*target, *src);
+			}
+		}, false});
+	});
+}
+
+void ResourceLoader::Push(Upload upload) {
+	std::lock_guard<std::mutex> lock(mutex);
+	ready.push_back(std::move(upload));
+}
+
+void ResourceLoader::UploadTexture(Texture &texture, const TextureSource &src) {
+	// Stage the pixels in a pixel unpack buffer, the copy into the texture is done by the driver
+	if (!pbo) {
+		glGenBuffers(1, &pbo);
+	}
+	GLState::BindBuffer(GL_PIXEL_UNPACK_BUFFER, pbo);
+	if (src.size > pboSize) {
+		pboSize = src.size;
+	}
+	// Orphan the previous storage so the upload never waits for the last transfer
+	glBufferData(GL_PIXEL_UNPACK_BUFFER, static_cast<GLsizeiptr>(pboSize), nullptr, GL_STREAM_DRAW);
+	void *dst = glMapBufferRange(GL_PIXEL_UNPACK_BUFFER, 0, static_cast<GLsizeiptr>(src.size),
+	                             GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_BUFFER_BIT);
+	if (dst) {
+		std::memcpy(dst, src.pixels.get(), src.size);
+		glUnmapBuffer(GL_PIXEL_UNPACK_BUFFER);
+		texture.Finish(src, nullptr);
+		GLState::BindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+	} else {
+		GLState::BindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+		texture.Finish(src, src.pixels.get());
+	}
+}
+
+void ResourceLoader::Update(float budgetMs) {
+	using Clock = std::chrono::steady_clock;
+	const auto deadline = Clock::now() + std::chrono::duration<float, std::milli>(budgetMs);
+	do {
+		Upload upload;
+		{
+			std::lock_guard<std::mutex> lock(mutex);
+			if (ready.empty()) {
+				return;
+			}
+			upload = std::move(ready.front());
+			ready.pop_front();
+		}
+		upload.finish();
+		std::lock_guard<std::mutex> lock(mutex);
+		(upload.isMesh ? pendingMeshes : pendingTextures) -= 1;
+	} while (Clock::now() < deadline);
+}
+
+void ResourceLoader::Finish() {
+	while (Pending() > 0) {
+		Update(1000.0f);
+		std::this_thread::yield();
+	}
+}
+
+int ResourceLoader::Pending() {
+	std::lock_guard<std::mutex> lock(mutex);
+	return pendingMeshes + pendingTextures;
+}
@@ -1,91 +1,198 @@
 #include "resources/Resources.h"
-#include <unordered_map>
+#include "rendering/GLState.h"
+#include "resources/ResourceLoader.h"
+#include "core/engine/GameHeader.h"
+#include "core/util/FileWatcher.h"
+#include <algorithm>
 #include <iostream>
+#include <memory>
 
-// Global repository of loaded resources
-static std::unordered_map<std::string, std::weak_ptr<Mesh>> meshMap;
-static std::unordered_map<std::string, std::weak_ptr<Shader>> shaderMap;
-static std::unordered_map<std::string, std::weak_ptr<Texture>> textureMap;
-
-std::shared_ptr<Mesh> AcquireMesh(const char *name) {
-	std::weak_ptr<Mesh> &mesh = meshMap[std::string(name)];
-	if (mesh.expired()) {
-		std::shared_ptr<Mesh> newMesh(new Mesh(name));
-		mesh = newMesh;
-		return newMesh;
-	} else {
-		return mesh.lock();
+namespace {
+	// Function statics, objects may acquire resources during static initialization
+	ResourcePool<Mesh> &Meshes() { return ResourcePool<Mesh>::Instance(); }
+	ResourcePool<Shader> &Shaders() { return ResourcePool<Shader>::Instance(); }
+	ResourcePool<Texture> &Textures() { return ResourcePool<Texture>::Instance(); }
+
+	// Shader files written since the last frame, see CheckForShaderUpdates
+	std::unique_ptr<FileWatcher> shaderWatcher;
+	std::vector<std::string> changedShaderFiles;
+
+	ResourceStats stats;
+
+	// Texture arrays share the pool under their own variant
+	constexpr uint32_t TEXTURE_ARRAY_VARIANT = ~0u;
+
+	uint32_t TextureVariant(int rows, int cols, TextureType type) {
+		return static_cast<uint32_t>(type) | static_cast<uint32_t>(rows) << 8 | static_cast<uint32_t>(cols) << 20;
+	}
+}
+
+Handle<Mesh> AcquireMesh(Atom name) {
+	if (const Handle<Mesh> mesh = Meshes().Find(name)) {
+		Meshes().Touch(mesh);
+		stats.hits += 1;
+		return mesh;
+	}
+	stats.misses += 1;
+	if (GH_ASYNC_LOADING && ResourceLoader::IsRunning()) {
+		const Handle<Mesh> mesh = Meshes().Emplace(name, 0);
+		ResourceLoader::LoadMesh(mesh, name.CStr());
+		return mesh;
+	}
+	return Meshes().Emplace(name, 0, name.CStr());
+}
+
+Handle<Mesh> AcquireMesh(const char *name) {
+	return AcquireMesh(Atom(name));
+}
+
+Handle<Shader> AcquireShader(Atom name) {
+	if (const Handle<Shader> shader = Shaders().Find(name)) {
+		stats.hits += 1;
+		return shader;
 	}
+	stats.misses += 1;
+	return Shaders().Emplace(name, 0, name.CStr());
+}
+
+Handle<Shader> AcquireShader(const char *name) {
+	return AcquireShader(Atom(name));
 }
 
-std::shared_ptr<Shader> AcquireShader(const char *name) {
-	std::weak_ptr<Shader> &shader = shaderMap[std::string(name)];
-	if (shader.expired()) {
-		std::shared_ptr<Shader> newShader(new Shader(name));
-		shader = newShader;
-		return newShader;
-	} else {
-		return shader.lock();
+Handle<Texture> AcquireTexture(Atom name, int rows, int cols, TextureType type) {
+	const uint32_t variant = TextureVariant(rows, cols, type);
+	if (const Handle<Texture> tex = Textures().Find(name, variant)) {
+		Textures().Touch(tex);
+		stats.hits += 1;
+		return tex;
+	}
+	stats.misses += 1;
+	if (GH_ASYNC_LOADING && ResourceLoader::IsRunning()) {
+		const Handle<Texture> tex = Textures().Emplace(name, variant);
+		tex->SetSource(name.CStr(), rows, cols, type);
+		ResourceLoader::LoadTexture(tex, name.CStr(), rows, cols, type);
+		return tex;
 	}
+	return Textures().Emplace(name, variant, name.CStr(), rows, cols, type);
 }
 
-std::shared_ptr<Texture> AcquireTexture(const char *name, int rows, int cols, TextureType type) {
-	// Create a unique key that includes texture type
-	std::string key = std::string(name) + "_" + std::to_string(static_cast<int>(type));
-
-	std::weak_ptr<Texture> &tex = textureMap[key];
-	if (tex.expired()) {
-		std::shared_ptr<Texture> newTex(new Texture(name, rows, cols, type));
-		tex = newTex;
-		return newTex;
-	} else {
-		return tex.lock();
+Handle<Texture> AcquireTexture(const char *name, int rows, int cols, TextureType type) {
+	return AcquireTexture(Atom(name), rows, cols, type);
+}
+
+Handle<Texture> AcquireTextureArray(const std::vector<std::string> &names) {
+	std::string key;
+	for (const std::string &name: names) {
+		key += name + "|";
+	}
+	if (const Handle<Texture> tex = Textures().Find(key, TEXTURE_ARRAY_VARIANT)) {
+		Textures().Touch(tex);
+		stats.hits += 1;
+		return tex;
 	}
+	stats.misses += 1;
+
+	const Handle<Texture> tex = Textures().Emplace(Atom(key), TEXTURE_ARRAY_VARIANT);
+	if (GH_ASYNC_LOADING && ResourceLoader::IsRunning()) {
+		ResourceLoader::LoadTextureArray(tex, names);
+	} else if (TextureSource src; Texture::DecodeArray(names, src)) {
+		tex->Finish(src, src.pixels.get());
+	}
+	return tex;
+}
+
+void ReleaseResources() {
+	shaderWatcher.reset();
+	Meshes().Clear();
+	Textures().Clear();
+	Shaders().Clear();
+}
+
+void PinResource(Handle<Mesh> mesh) { Meshes().Pin(mesh); }
+
+void PinResource(Handle<Texture> texture) { Textures().Pin(texture); }
+
+void UnpinResource(Handle<Mesh> mesh) { Meshes().Unpin(mesh); }
+
+void UnpinResource(Handle<Texture> texture) { Textures().Unpin(texture); }
+
+void BeginResourceUse() {
+	Meshes().Tick();
+	Textures().Tick();
+}
+
+void TouchResource(Handle<Mesh> mesh) { Meshes().Touch(mesh); }
+
+void TouchResource(Handle<Texture> texture) { Textures().Touch(texture); }
+
+void TrimResources(size_t budgetBytes) {
+	// Textures first, they are the bulk of it
+	size_t meshBytes = 0;
+	Meshes().ForEach([&](std::string_view, const Mesh &mesh) { meshBytes += mesh.GpuBytes(); });
+	const size_t textureBudget = budgetBytes > meshBytes ? budgetBytes - meshBytes : 0;
+	stats.evictedBytes += Textures().Evict(textureBudget, [](const Texture &tex) { return tex.GpuBytes(); },
+	                                       &stats.evicted);
+	size_t textureBytes = 0;
+	Textures().ForEach([&](std::string_view, const Texture &tex) { textureBytes += tex.GpuBytes(); });
+	const size_t meshBudget = budgetBytes > textureBytes ? budgetBytes - textureBytes : 0;
+	stats.evictedBytes += Meshes().Evict(meshBudget, [](const Mesh &mesh) { return mesh.GpuBytes(); },
+	                                     &stats.evicted);
+
+	meshBytes = 0;
+	Meshes().ForEach([&](std::string_view, const Mesh &mesh) { meshBytes += mesh.GpuBytes(); });
+	stats.residentBytes = meshBytes + textureBytes;
+}
+
+const ResourceStats &GetResourceStats() {
+	return stats;
 }
 
 // Function to check for shader updates
 void CheckForShaderUpdates(bool forceReload) {
-	// Unbind any current shader before reloading
-	glUseProgram(0);
-	glFlush();
-	glFinish();
-
-	for (auto& pair : shaderMap) {
-		if (!pair.second.expired()) {
-			std::shared_ptr<Shader> shader = pair.second.lock();
-			if (forceReload) {
-				// Force reload the shader
-				bool success = shader->LoadShaders();
-				std::cout << "Shader " << pair.first << " "
-				          << (success ? "force reloaded successfully" : "reload failed") << std::endl;
-			} else {
-				// Check for updates normally
-				shader->CheckForUpdates();
-			}
-		}
+	if (forceReload) {
+		Shaders().ForEach([](std::string_view name, Shader &shader) {
+			// Force reload the shader
+			bool success = shader.LoadShaders();
+			std::cout << "Shader " << name << " "
+			          << (success ? "force reloaded successfully" : "reload failed") << std::endl;
+		});
+		return;
+	}
+	if (!GH_SHADER_HOT_RELOAD) {
+		return;
 	}
 
-	// Final flush to ensure all shader operations complete
-	glFlush();
-	glFinish();
+	// The watcher thread does the file system work, here we only drain its events
+	if (!shaderWatcher) {
+		shaderWatcher = std::make_unique<FileWatcher>("assets/shaders");
+	}
+	changedShaderFiles.clear();
+	shaderWatcher->Poll(changedShaderFiles);
+	std::vector<std::string_view> reloaded;
+	for (const std::string &file: changedShaderFiles) {
+		// texture.frag, texture.vert.spv -> texture
+		const std::string_view name = std::string_view(file).substr(0, file.find('.'));
+		if (std::find(reloaded.begin(), reloaded.end(), name) != reloaded.end()) {
+			continue;
+		}
+		if (const Handle<Shader> shader = Shaders().Find(name)) {
+			std::cout << "Shader " << name << " changed, reloading...\n";
+			shader->LoadShaders();
+			reloaded.push_back(name);
+		}
+	}
 }
 
 // Function to reload a specific shader by name
 bool ReloadShader(const char* name) {
-	auto it = shaderMap.find(std::string(name));
-	if (it != shaderMap.end() && !it->second.expired()) {
+	const Handle<Shader> shader = Shaders().Find(name);
+	if (shader) {
 		std::cout << "Forcibly recreating shader: " << name << std::endl;
 
-		// Unbind any current shader
-		glUseProgram(0);
-		glFlush();
-		glFinish();
-
-		// Create a completely new shader object
-		std::shared_ptr<Shader> newShader(new Shader(name));
-		it->second = newShader;
+		// Create a completely new shader object, in the same slot so every handle sees it
+		Shaders().Replace(shader, name);
 
 		return true;
 	}
 	return false;
-}
\ No newline at end of file
+}
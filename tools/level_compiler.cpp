@@ -0,0 +1,88 @@
+// Offline level compiler: validates YAML levels and writes the binary format read by LevelConfig.
+// Usage: level_compiler [--force] [--check] <file.yaml | directory>...
+// --check only validates, nothing is written. Any problem makes the level fail.
+#include "game/LevelConfig.h"
+#include <yaml-cpp/yaml.h>
+#include <filesystem>
+#include <iostream>
+#include <string>
+#include <vector>
+
+namespace fs = std::filesystem;
+
+namespace {
+	bool Compile(const fs::path &yamlPath, bool force, bool checkOnly) {
+		const std::string src = yamlPath.string();
+		const std::string dst = LevelConfig::BinaryPathFor(src);
+		if (!force && !checkOnly && LevelConfig::IsUpToDate(src, dst)) {
+			std::cout << "up to date  " << dst << "\n";
+			return true;
+		}
+
+		std::vector<std::string> errors;
+		LevelConfig config;
+		try {
+			config = LevelConfig::FromYAML(src, errors);
+		} catch (const YAML::Exception &e) {
+			errors.emplace_back(e.what());
+		}
+		if (errors.empty()) {
+			config.Validate(errors);
+		}
+		for (const std::string &error: errors) {
+			std::cerr << src << ": " << error << "\n";
+		}
+		if (!errors.empty()) {
+			return false;
+		}
+
+		int links = 0;
+		for (const ObjectConfig &obj: config.objects) {
+			links += obj.portalCount;
+		}
+		if (checkOnly) {
+			std::cout << "valid       " << src << ": " << config.objects.size() << " objects, " << links << " links\n";
+			return true;
+		}
+		if (!config.WriteBinary(dst)) {
+			return false;
+		}
+		std::cout << "compiled    " << dst << ": " << config.objects.size() << " objects, " << links << " links, "
+		          << fs::file_size(src) << " -> " << fs::file_size(dst) << " bytes\n";
+		return true;
+	}
+}
+
+int main(int argc, char **argv) {
+	bool force = false;
+	bool checkOnly = false;
+	std::vector<fs::path> inputs;
+	for (int i = 1; i < argc; ++i) {
+		const std::string arg = argv[i];
+		if (arg == "--force") {
+			force = true;
+		} else if (arg == "--check") {
+			checkOnly = true;
+		} else {
+			inputs.emplace_back(arg);
+		}
+	}
+	if (inputs.empty()) {
+		std::cerr << "usage: level_compiler [--force] [--check] <file.yaml | directory>...\n";
+		return 1;
+	}
+
+	int failed = 0;
+	for (const fs::path &input: inputs) {
+		if (fs::is_directory(input)) {
+			for (const auto &entry: fs::directory_iterator(input)) {
+				if (entry.path().extension() == ".yaml") {
+					failed += !Compile(entry.path(), force, checkOnly);
+				}
+			}
+		} else {
+			failed += !Compile(input, force, checkOnly);
+		}
+	}
+	return failed == 0 ? 0 : 1;
+}
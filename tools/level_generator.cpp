@@ -0,0 +1,248 @@
+// Procedural stress levels: many grounds and tunnels of every type, linked in a chosen topology.
+// Usage: level_generator [--tunnels N] [--grounds N] [--props N] [--topology T] [--seed S] <out.yaml>
+//        level_generator --sweep <directory>
+// Topologies: pairs (door to the same door of a twin, as the shipped levels), chain, loop, self,
+// scale (chain of SCALE tunnels halving in size) and mixed (random pairing of all doors).
+// --props drops crates and balls inside the tunnels, the sloped ones roll them through the doors.
+// --sweep writes a series of growing levels for the level_scaling_bench target.
+// Every level is parsed back and validated before the tool succeeds.
+#include "core/engine/GameHeader.h"
+#include "game/LevelConfig.h"
+#include <yaml-cpp/yaml.h>
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace fs = std::filesystem;
+
+namespace {
+	// Every door is a portal, and the engine draws at most GH_MAX_PORTALS of them
+	constexpr int MAX_TUNNELS = GH_MAX_PORTALS / 2;
+	constexpr float GROUND_SIZE = 8.0f; // ground.obj spans [-1, 1], scaled by 4
+	constexpr float TUNNEL_SPACING = 6.0f;
+	constexpr float PROP_SIZE = 0.1f; // GH_PROP_SIZE, relative to the tunnel size
+
+	const char *const TUNNEL_TYPES[] = {"NORMAL", "SCALE", "SLOPE"};
+
+	struct Options {
+		int tunnels = 6;
+		int grounds = 16;
+		int props = 0;
+		std::string topology = "pairs";
+		unsigned seed = 1;
+	};
+
+	struct Door {
+		int tunnel;
+		int door;
+	};
+
+	// links[t][d - 1] is the door that door d of tunnel t leads to
+	using Links = std::vector<std::array<Door, 2>>;
+
+	void Link(Links &links, Door a, Door b) {
+		links[a.tunnel][a.door - 1] = b;
+		links[b.tunnel][b.door - 1] = a;
+	}
+
+	bool MakeLinks(const Options &options, std::mt19937 &rng, Links &links) {
+		const int n = options.tunnels;
+		links.assign(n, {Door{-1, 0}, Door{-1, 0}});
+		if (options.topology == "pairs") {
+			for (int t = 0; t + 1 < n; t += 2) {
+				Link(links, {t, 1}, {t + 1, 1});
+				Link(links, {t, 2}, {t + 1, 2});
+			}
+			if (n % 2) {
+				Link(links, {n - 1, 1}, {n - 1, 1});
+				Link(links, {n - 1, 2}, {n - 1, 2});
+			}
+		} else if (options.topology == "chain" || options.topology == "scale") {
+			for (int t = 0; t + 1 < n; ++t) {
+				Link(links, {t, 2}, {t + 1, 1});
+			}
+			Link(links, {0, 1}, {0, 1});
+			Link(links, {n - 1, 2}, {n - 1, 2});
+		} else if (options.topology == "loop") {
+			for (int t = 0; t < n; ++t) {
+				Link(links, {t, 2}, {(t + 1) % n, 1});
+			}
+		} else if (options.topology == "self") {
+			for (int t = 0; t < n; ++t) {
+				Link(links, {t, 1}, {t, 1});
+				Link(links, {t, 2}, {t, 2});
+			}
+		} else if (options.topology == "mixed") {
+			std::vector<Door> doors;
+			for (int t = 0; t < n; ++t) {
+				doors.push_back({t, 1});
+				doors.push_back({t, 2});
+			}
+			std::shuffle(doors.begin(), doors.end(), rng);
+			for (size_t i = 0; i + 1 < doors.size(); i += 2) {
+				Link(links, doors[i], doors[i + 1]);
+			}
+		} else {
+			std::cerr << "unknown topology " << options.topology << "\n";
+			return false;
+		}
+		return true;
+	}
+
+	bool Generate(const Options &options, const fs::path &path) {
+		if (options.tunnels < 1 || options.tunnels > MAX_TUNNELS || options.grounds < 1 || options.props < 0) {
+			std::cerr << path.string() << ": tunnels must be in [1, " << MAX_TUNNELS
+			          << "], grounds at least 1, props not negative\n";
+			return false;
+		}
+		std::mt19937 rng(options.seed);
+		Links links;
+		if (!MakeLinks(options, rng, links)) {
+			return false;
+		}
+
+		if (path.has_parent_path()) {
+			fs::create_directories(path.parent_path());
+		}
+		std::ofstream out(path);
+		out << "name: \"Stress " << options.topology << " " << options.tunnels << "x" << options.grounds << "\"\n";
+		out << "player_start: [0, 1.5, 1]\n";
+		out << "objects:\n";
+
+		// Grounds tile a square around the origin, one in four sloped
+		const int side = static_cast<int>(std::ceil(std::sqrt(static_cast<double>(options.grounds))));
+		for (int g = 0; g < options.grounds; ++g) {
+			const float x = (static_cast<float>(g % side) - static_cast<float>(side / 2)) * GROUND_SIZE;
+			const float z = (static_cast<float>(g / side) - static_cast<float>(side / 2)) * GROUND_SIZE;
+			const bool slope = g % 4 == 3;
+			out << "  - type: Ground\n";
+			out << "    id: ground" << g << "\n";
+			if (slope) {
+				out << "    subtype: SLOPE\n";
+			}
+			out << "    position: [" << x << ", 0, " << z << "]\n";
+			out << "    scale: [4, " << (slope ? 2 : 4) << ", 4]\n";
+		}
+
+		// Tunnels stand in a row, cycling through the types unless the topology fixes it
+		const bool scaleChain = options.topology == "scale";
+		const auto tunnelSize = [&](int t) { return scaleChain ? std::ldexp(1.0f, -(t % 6)) : 1.0f; };
+		const auto tunnelX = [](int t) { return static_cast<float>(t) * TUNNEL_SPACING; };
+		for (int t = 0; t < options.tunnels; ++t) {
+			const char *type = scaleChain ? "SCALE" : TUNNEL_TYPES[t % 3];
+			const float size = tunnelSize(t);
+			out << "  - type: Tunnel\n";
+			out << "    id: tunnel" << t << "\n";
+			out << "    subtype: " << type << "\n";
+			out << "    position: [" << tunnelX(t) << ", 0, -2]\n";
+			out << "    scale: [" << size << ", " << size << ", " << (2.0f * size) << "]\n";
+			out << "    portals:\n";
+			for (int d = 1; d <= 2; ++d) {
+				const Door &to = links[t][d - 1];
+				if (to.tunnel < 0) {
+					continue;
+				}
+				out << "      - door: " << d << "\n";
+				out << "        connects_to: tunnel" << to.tunnel << ".door" << to.door << "\n";
+			}
+		}
+		// Props are dealt to the tunnels in turn and stacked inside them, tunnel.obj spans
+		// x [-0.8, 0.8], y [0, 2.2] and z [-1, 1], scaled by [size, size, 2 size]
+		std::uniform_real_distribution<float> across(-0.5f, 0.5f);
+		std::uniform_real_distribution<float> along(-0.8f, 0.8f);
+		for (int p = 0; p < options.props; ++p) {
+			const int t = p % options.tunnels;
+			const float size = tunnelSize(t);
+			const float height = 0.5f + static_cast<float>(p / options.tunnels % 16) * 2.5f * PROP_SIZE;
+			out << "  - type: Prop\n";
+			out << "    id: prop" << p << "\n";
+			out << "    subtype: " << (p % 2 ? "BALL" : "CRATE") << "\n";
+			out << "    position: [" << tunnelX(t) + across(rng) * size << ", " << height * size << ", "
+			    << -2.0f + along(rng) * 2.0f * size << "]\n";
+			out << "    scale: " << PROP_SIZE * size << "\n";
+		}
+		out.close();
+		if (!out) {
+			std::cerr << path.string() << ": write failed\n";
+			return false;
+		}
+
+		// Parse the result back, a generated level must pass the same checks as a shipped one
+		std::vector<std::string> errors;
+		try {
+			const LevelConfig config = LevelConfig::FromYAML(path.string(), errors);
+			if (errors.empty()) {
+				config.Validate(errors);
+			}
+		} catch (const YAML::Exception &e) {
+			errors.emplace_back(e.what());
+		}
+		for (const std::string &error: errors) {
+			std::cerr << path.string() << ": " << error << "\n";
+		}
+		if (!errors.empty()) {
+			return false;
+		}
+		std::cout << "generated   " << path.string() << ": " << options.grounds << " grounds, " << options.tunnels
+		          << " tunnels, " << options.props << " props, " << options.topology << "\n";
+		return true;
+	}
+
+	// Object counts grow by 3x per step, the portal count up to the engine limit
+	bool Sweep(const fs::path &dir) {
+		fs::create_directories(dir);
+		const char *const topologies[] = {"pairs", "chain", "loop", "self", "scale", "mixed"};
+		bool ok = true;
+		int step = 0;
+		for (int grounds = 8; grounds <= 6000; grounds *= 3, ++step) {
+			Options options;
+			options.grounds = grounds;
+			options.tunnels = std::min(2 + step * 3, MAX_TUNNELS);
+			options.topology = topologies[step % std::size(topologies)];
+			options.seed = static_cast<unsigned>(step + 1);
+			char name[32];
+			std::snprintf(name, sizeof(name), "stress-%05d.yaml", grounds + options.tunnels);
+			ok &= Generate(options, dir / name);
+		}
+		return ok;
+	}
+}
+
+int main(int argc, char **argv) {
+	Options options;
+	fs::path output;
+	for (int i = 1; i < argc; ++i) {
+		const std::string arg = argv[i];
+		const bool hasValue = i + 1 < argc;
+		if (arg == "--sweep" && hasValue) {
+			return Sweep(argv[++i]) ? 0 : 1;
+		} else if (arg == "--tunnels" && hasValue) {
+			options.tunnels = std::atoi(argv[++i]);
+		} else if (arg == "--grounds" && hasValue) {
+			options.grounds = std::atoi(argv[++i]);
+		} else if (arg == "--props" && hasValue) {
+			options.props = std::atoi(argv[++i]);
+		} else if (arg == "--topology" && hasValue) {
+			options.topology = argv[++i];
+		} else if (arg == "--seed" && hasValue) {
+			options.seed = static_cast<unsigned>(std::strtoul(argv[++i], nullptr, 10));
+		} else {
+			output = arg;
+		}
+	}
+	if (output.empty()) {
+		std::cerr << "usage: level_generator [--tunnels N] [--grounds N] [--props N]"
+		             " [--topology pairs|chain|loop|self|scale|mixed] [--seed S] <out.yaml>\n"
+		             "       level_generator --sweep <directory>\n";
+		return 1;
+	}
+	return Generate(options, output) ? 0 : 1;
+}
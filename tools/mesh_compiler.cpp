@@ -0,0 +1,67 @@
+// Offline mesh compiler: converts OBJ files into the binary format read by Mesh.
+// Usage: mesh_compiler [--force] <file.obj | directory>...
+#include "resources/MeshBinary.h"
+#include "resources/MeshData.h"
+#include <filesystem>
+#include <iostream>
+#include <string>
+#include <vector>
+
+namespace fs = std::filesystem;
+
+namespace {
+	bool Compile(const fs::path &objPath, bool force) {
+		const std::string src = objPath.string();
+		const std::string dst = MeshBinary::PathFor(src);
+		if (!force && MeshBinary::IsUpToDate(src, dst)) {
+			std::cout << "up to date  " << dst << "\n";
+			return true;
+		}
+
+		MeshData data;
+		if (!LoadObj(src, data)) {
+			std::cerr << "cannot read " << src << "\n";
+			return false;
+		}
+		const uint32_t rawVerts = data.VertexCount();
+		data.Weld();
+		if (!MeshBinary::Write(data, dst)) {
+			return false;
+		}
+		std::cout << "compiled    " << dst << ": " << rawVerts << " -> " << data.VertexCount() << " vertices, "
+		          << data.indices.size() / 3 << " triangles, " << data.colliders.size() << " colliders, "
+		          << fs::file_size(dst) << " bytes\n";
+		return true;
+	}
+}
+
+int main(int argc, char **argv) {
+	bool force = false;
+	std::vector<fs::path> inputs;
+	for (int i = 1; i < argc; ++i) {
+		const std::string arg = argv[i];
+		if (arg == "--force") {
+			force = true;
+		} else {
+			inputs.emplace_back(arg);
+		}
+	}
+	if (inputs.empty()) {
+		std::cerr << "usage: mesh_compiler [--force] <file.obj | directory>...\n";
+		return 1;
+	}
+
+	int failed = 0;
+	for (const fs::path &input: inputs) {
+		if (fs::is_directory(input)) {
+			for (const auto &entry: fs::directory_iterator(input)) {
+				if (entry.path().extension() == ".obj") {
+					failed += !Compile(entry.path(), force);
+				}
+			}
+		} else {
+			failed += !Compile(input, force);
+		}
+	}
+	return failed == 0 ? 0 : 1;
+}
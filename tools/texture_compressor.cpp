@@ -0,0 +1,367 @@
+// Offline texture compressor: converts BMP files into block compressed DDS files with a full mip chain.
+// Usage: texture_compressor [--force] [--format bc1|bc3|bc7] [--tiles RxC] <file.bmp | directory>...
+// --tiles must match the rows and cols the texture is acquired with, each tile becomes an array layer.
+#include "resources/BmpImage.h"
+#include "resources/DdsImage.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <iostream>
+#include <string>
+#include <vector>
+
+namespace fs = std::filesystem;
+
+namespace {
+	struct Rgba {
+		uint8_t c[4];
+	};
+
+	// Tightly packed RGBA8 image
+	struct Image {
+		int width = 0;
+		int height = 0;
+		std::vector<Rgba> pixels;
+	};
+
+	// 2x2 box filter, odd sizes clamp the last row or column
+	Image Downsample(const Image &src) {
+		Image dst;
+		dst.width = std::max(1, src.width / 2);
+		dst.height = std::max(1, src.height / 2);
+		dst.pixels.resize(static_cast<size_t>(dst.width) * dst.height);
+		for (int y = 0; y < dst.height; ++y) {
+			const int y0 = std::min(2 * y, src.height - 1);
+			const int y1 = std::min(2 * y + 1, src.height - 1);
+			for (int x = 0; x < dst.width; ++x) {
+				const int x0 = std::min(2 * x, src.width - 1);
+				const int x1 = std::min(2 * x + 1, src.width - 1);
+				const Rgba &a = src.pixels[y0 * src.width + x0];
+				const Rgba &b = src.pixels[y0 * src.width + x1];
+				const Rgba &c = src.pixels[y1 * src.width + x0];
+				const Rgba &d = src.pixels[y1 * src.width + x1];
+				Rgba &out = dst.pixels[y * dst.width + x];
+				for (int k = 0; k < 4; ++k) {
+					out.c[k] = static_cast<uint8_t>((a.c[k] + b.c[k] + c.c[k] + d.c[k] + 2) / 4);
+				}
+			}
+		}
+		return dst;
+	}
+
+	// Endpoints along the principal axis of the block colors
+	void FitEndpoints(const Rgba block[16], float lo[3], float hi[3]) {
+		float mean[3] = {};
+		for (int i = 0; i < 16; ++i) {
+			for (int k = 0; k < 3; ++k) {
+				mean[k] += block[i].c[k];
+			}
+		}
+		for (float &m: mean) {
+			m /= 16.0f;
+		}
+		float cov[6] = {};
+		for (int i = 0; i < 16; ++i) {
+			const float r = block[i].c[0] - mean[0];
+			const float g = block[i].c[1] - mean[1];
+			const float b = block[i].c[2] - mean[2];
+			cov[0] += r * r;
+			cov[1] += r * g;
+			cov[2] += r * b;
+			cov[3] += g * g;
+			cov[4] += g * b;
+			cov[5] += b * b;
+		}
+		// A few power iterations are plenty for a 3x3 matrix
+		float axis[3] = {1.0f, 1.0f, 1.0f};
+		for (int it = 0; it < 8; ++it) {
+			const float x = cov[0] * axis[0] + cov[1] * axis[1] + cov[2] * axis[2];
+			const float y = cov[1] * axis[0] + cov[3] * axis[1] + cov[4] * axis[2];
+			const float z = cov[2] * axis[0] + cov[4] * axis[1] + cov[5] * axis[2];
+			const float len = std::sqrt(x * x + y * y + z * z);
+			if (len < 1e-6f) {
+				break;
+			}
+			axis[0] = x / len;
+			axis[1] = y / len;
+			axis[2] = z / len;
+		}
+		float minT = 0.0f, maxT = 0.0f;
+		for (int i = 0; i < 16; ++i) {
+			const float t = (block[i].c[0] - mean[0]) * axis[0] + (block[i].c[1] - mean[1]) * axis[1] +
+			                (block[i].c[2] - mean[2]) * axis[2];
+			minT = std::min(minT, t);
+			maxT = std::max(maxT, t);
+		}
+		for (int k = 0; k < 3; ++k) {
+			lo[k] = std::clamp(mean[k] + minT * axis[k], 0.0f, 255.0f);
+			hi[k] = std::clamp(mean[k] + maxT * axis[k], 0.0f, 255.0f);
+		}
+	}
+
+	int Distance(const Rgba &a, const int b[3]) {
+		const int r = a.c[0] - b[0], g = a.c[1] - b[1], bl = a.c[2] - b[2];
+		return r * r + g * g + bl * bl;
+	}
+
+	uint16_t To565(const float c[3]) {
+		const int r = static_cast<int>(std::lround(c[0] * 31.0f / 255.0f));
+		const int g = static_cast<int>(std::lround(c[1] * 63.0f / 255.0f));
+		const int b = static_cast<int>(std::lround(c[2] * 31.0f / 255.0f));
+		return static_cast<uint16_t>((r << 11) | (g << 5) | b);
+	}
+
+	void From565(uint16_t v, int out[3]) {
+		const int r = (v >> 11) & 31, g = (v >> 5) & 63, b = v & 31;
+		out[0] = (r << 3) | (r >> 2);
+		out[1] = (g << 2) | (g >> 4);
+		out[2] = (b << 3) | (b >> 2);
+	}
+
+	// Opaque four color mode: color0 > color1
+	void EncodeBC1(const Rgba block[16], uint8_t out[8]) {
+		float lo[3], hi[3];
+		FitEndpoints(block, lo, hi);
+		uint16_t c0 = To565(hi);
+		uint16_t c1 = To565(lo);
+		if (c0 < c1) {
+			std::swap(c0, c1);
+		}
+		uint32_t indices = 0;
+		if (c0 != c1) {
+			int palette[4][3];
+			From565(c0, palette[0]);
+			From565(c1, palette[1]);
+			for (int k = 0; k < 3; ++k) {
+				palette[2][k] = (2 * palette[0][k] + palette[1][k]) / 3;
+				palette[3][k] = (palette[0][k] + 2 * palette[1][k]) / 3;
+			}
+			for (int i = 0; i < 16; ++i) {
+				int best = 0, bestDist = Distance(block[i], palette[0]);
+				for (int p = 1; p < 4; ++p) {
+					const int d = Distance(block[i], palette[p]);
+					if (d < bestDist) {
+						best = p;
+						bestDist = d;
+					}
+				}
+				indices |= static_cast<uint32_t>(best) << (2 * i);
+			}
+		}
+		std::memcpy(out, &c0, 2);
+		std::memcpy(out + 2, &c1, 2);
+		std::memcpy(out + 4, &indices, 4);
+	}
+
+	// BMPs have no alpha, BC3 gets a constant opaque alpha block
+	void EncodeBC3(const Rgba block[16], uint8_t out[16]) {
+		std::memset(out, 0, 8);
+		out[0] = 255;
+		out[1] = 255;
+		EncodeBC1(block, out + 8);
+	}
+
+	// Little endian bit writer for BC7 blocks
+	struct BitWriter {
+		uint8_t *data;
+		int pos = 0;
+
+		void Write(uint32_t value, int bits) {
+			for (int i = 0; i < bits; ++i, ++pos) {
+				data[pos >> 3] |= static_cast<uint8_t>(((value >> i) & 1u) << (pos & 7));
+			}
+		}
+	};
+
+	// BC7 mode 6: one subset, 7 bit RGBA endpoints plus a p-bit each, 4 bit indices
+	void EncodeBC7(const Rgba block[16], uint8_t out[16]) {
+		static constexpr int WEIGHTS[16] = {0, 4, 9, 13, 17, 21, 26, 30, 34, 38, 43, 47, 51, 55, 60, 64};
+
+		float lo[3], hi[3];
+		FitEndpoints(block, lo, hi);
+		const uint8_t alpha = block[0].c[3];
+
+		// Try every p-bit pair and keep the one with the smallest error
+		int bestErr = -1;
+		int bestEnd[2][4] = {}, bestP[2] = {}, bestIdx[16] = {};
+		for (int p0 = 0; p0 < 2; ++p0) {
+			for (int p1 = 0; p1 < 2; ++p1) {
+				const float *src[2] = {lo, hi};
+				const int p[2] = {p0, p1};
+				int end[2][4], color[2][4];
+				for (int e = 0; e < 2; ++e) {
+					for (int k = 0; k < 4; ++k) {
+						const float v = k < 3 ? src[e][k] : alpha;
+						end[e][k] = std::clamp(static_cast<int>(std::lround((v - p[e]) / 2.0f)), 0, 127);
+						color[e][k] = (end[e][k] << 1) | p[e];
+					}
+				}
+				int err = 0, idx[16];
+				for (int i = 0; i < 16; ++i) {
+					int best = 0, bestDist = -1;
+					for (int w = 0; w < 16; ++w) {
+						int c[3];
+						for (int k = 0; k < 3; ++k) {
+							c[k] = (color[0][k] * (64 - WEIGHTS[w]) + color[1][k] * WEIGHTS[w] + 32) >> 6;
+						}
+						const int d = Distance(block[i], c);
+						if (bestDist < 0 || d < bestDist) {
+							best = w;
+							bestDist = d;
+						}
+					}
+					idx[i] = best;
+					err += bestDist;
+				}
+				if (bestErr < 0 || err < bestErr) {
+					bestErr = err;
+					std::memcpy(bestEnd, end, sizeof(end));
+					bestP[0] = p0;
+					bestP[1] = p1;
+					std::memcpy(bestIdx, idx, sizeof(idx));
+				}
+			}
+		}
+
+		// The anchor index is stored without its top bit, swap the endpoints if it is set
+		if (bestIdx[0] & 8) {
+			std::swap(bestEnd[0], bestEnd[1]);
+			std::swap(bestP[0], bestP[1]);
+			for (int &i: bestIdx) {
+				i = 15 - i;
+			}
+		}
+
+		std::memset(out, 0, 16);
+		BitWriter bits{out};
+		bits.Write(1u << 6, 7);
+		for (int k = 0; k < 4; ++k) {
+			bits.Write(static_cast<uint32_t>(bestEnd[0][k]), 7);
+			bits.Write(static_cast<uint32_t>(bestEnd[1][k]), 7);
+		}
+		bits.Write(static_cast<uint32_t>(bestP[0]), 1);
+		bits.Write(static_cast<uint32_t>(bestP[1]), 1);
+		for (int i = 0; i < 16; ++i) {
+			bits.Write(static_cast<uint32_t>(bestIdx[i]), i == 0 ? 3 : 4);
+		}
+	}
+
+	void EncodeLevel(const Image &image, BlockFormat format, std::vector<uint8_t> &out) {
+		const size_t blockBytes = DdsImage::BlockBytes(format);
+		for (int by = 0; by < image.height; by += 4) {
+			for (int bx = 0; bx < image.width; bx += 4) {
+				// Blocks on the border repeat the last row and column
+				Rgba block[16];
+				for (int y = 0; y < 4; ++y) {
+					for (int x = 0; x < 4; ++x) {
+						const int px = std::min(bx + x, image.width - 1);
+						const int py = std::min(by + y, image.height - 1);
+						block[y * 4 + x] = image.pixels[py * image.width + px];
+					}
+				}
+				const size_t at = out.size();
+				out.resize(at + blockBytes);
+				switch (format) {
+					case BlockFormat::BC1: EncodeBC1(block, &out[at]);
+						break;
+					case BlockFormat::BC3: EncodeBC3(block, &out[at]);
+						break;
+					case BlockFormat::BC7: EncodeBC7(block, &out[at]);
+						break;
+				}
+			}
+		}
+	}
+
+	bool Compress(const fs::path &bmpPath, BlockFormat format, int rows, int cols, bool force) {
+		const std::string src = bmpPath.string();
+		const std::string dst = DdsPathFor(src);
+		if (!force && DdsIsUpToDate(src, dst)) {
+			std::cout << "up to date  " << dst << "\n";
+			return true;
+		}
+
+		BmpImage bmp;
+		if (!LoadBMP(src, rows, cols, bmp)) {
+			std::cerr << "cannot read " << src << "\n";
+			return false;
+		}
+
+		// Rows are kept in the order Texture uploads them, so both paths look the same
+		const int mipCount = 1 + static_cast<int>(std::log2(std::max(bmp.width, bmp.height)));
+		const size_t tileSize = static_cast<size_t>(bmp.width) * bmp.height;
+		std::vector<uint8_t> blocks;
+		for (int layer = 0; layer < bmp.layers; ++layer) {
+			const auto *bgr = static_cast<const uint8_t *>(bmp.pixels.get()) + layer * tileSize * 3;
+			Image level;
+			level.width = bmp.width;
+			level.height = bmp.height;
+			level.pixels.resize(tileSize);
+			for (size_t i = 0; i < tileSize; ++i) {
+				level.pixels[i] = {{bgr[3 * i + 2], bgr[3 * i + 1], bgr[3 * i], 255}};
+			}
+			for (int m = 0; m < mipCount; ++m) {
+				EncodeLevel(level, format, blocks);
+				if (m + 1 < mipCount) {
+					level = Downsample(level);
+				}
+			}
+		}
+		if (!WriteDDS(dst, format, bmp.width, bmp.height, bmp.layers, mipCount, blocks)) {
+			return false;
+		}
+		std::cout << "compressed  " << dst << ": " << bmp.width << "x" << bmp.height << " x" << bmp.layers << ", "
+		          << mipCount << " mips, " << fs::file_size(src) << " -> " << fs::file_size(dst) << " bytes\n";
+		return true;
+	}
+}
+
+int main(int argc, char **argv) {
+	bool force = false;
+	BlockFormat format = BlockFormat::BC1;
+	int rows = 1, cols = 1;
+	std::vector<fs::path> inputs;
+	bool usage = false;
+	for (int i = 1; i < argc; ++i) {
+		const std::string arg = argv[i];
+		if (arg == "--force") {
+			force = true;
+		} else if (arg == "--format" && i + 1 < argc) {
+			const std::string name = argv[++i];
+			if (name == "bc1") {
+				format = BlockFormat::BC1;
+			} else if (name == "bc3") {
+				format = BlockFormat::BC3;
+			} else if (name == "bc7") {
+				format = BlockFormat::BC7;
+			} else {
+				usage = true;
+			}
+		} else if (arg == "--tiles" && i + 1 < argc) {
+			usage |= std::sscanf(argv[++i], "%dx%d", &rows, &cols) != 2 || rows < 1 || cols < 1;
+		} else {
+			inputs.emplace_back(arg);
+		}
+	}
+	if (inputs.empty() || usage) {
+		std::cerr << "usage: texture_compressor [--force] [--format bc1|bc3|bc7] [--tiles RxC] "
+		             "<file.bmp | directory>...\n";
+		return 1;
+	}
+
+	int failed = 0;
+	for (const fs::path &input: inputs) {
+		if (fs::is_directory(input)) {
+			for (const auto &entry: fs::directory_iterator(input)) {
+				if (entry.path().extension() == ".bmp") {
+					failed += !Compress(entry.path(), format, rows, cols, force);
+				}
+			}
+		} else {
+			failed += !Compress(input, format, rows, cols, force);
+		}
+	}
+	return failed == 0 ? 0 : 1;
+}